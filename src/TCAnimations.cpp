@@ -0,0 +1,157 @@
+#include "TCAnimations.h"
+
+#define N(row) ( row )
+#define P(row) ( TCAnimations::ROW_PREVIOUS + ( row ) )
+#define B TCAnimations::ROW_BLANK
+
+const TCAnimations::Animation BUILT_IN_ANIMATIONS[TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS] PROGMEM = {
+  { //1: both digits scroll down
+    9,
+    { 40, 40, 40, 40, 40, 40, 40, 40, 40 },
+    {
+      { B, P(0), P(1), P(2), P(3), P(4), P(5), P(6) },
+      { N(7), B, P(0), P(1), P(2), P(3), P(4), P(5) },
+      { N(6), N(7), B, P(0), P(1), P(2), P(3), P(4) },
+      { N(5), N(6), N(7), B, P(0), P(1), P(2), P(3) },
+      { N(4), N(5), N(6), N(7), B, P(0), P(1), P(2) },
+      { N(3), N(4), N(5), N(6), N(7), B, P(0), P(1) },
+      { N(2), N(3), N(4), N(5), N(6), N(7), B, P(0) },
+      { N(1), N(2), N(3), N(4), N(5), N(6), N(7), B },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), N(7) }
+    }
+  },
+  { //2: blank line wipes the new digit down over the previous one
+    9,
+    { 40, 40, 40, 40, 40, 40, 40, 40, 40 },
+    {
+      { B, P(1), P(2), P(3), P(4), P(5), P(6), P(7) },
+      { N(0), B, P(2), P(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), B, P(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), B, P(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), B, P(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), B, P(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), B, P(7) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), B },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), N(7) }
+    }
+  },
+  { //3: new digit wipes down over the previous one
+    8,
+    { 40, 40, 40, 40, 40, 40, 40, 40 },
+    {
+      { N(0), P(1), P(2), P(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), P(2), P(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), P(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), P(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), P(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), P(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), P(7) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), N(7) }
+    }
+  },
+  { //4: previous digit drops down behind a blank line, new one is uncovered
+    9,
+    { 40, 40, 40, 40, 40, 40, 40, 40, 40 },
+    {
+      { B, P(0), P(1), P(2), P(3), P(4), P(5), P(6) },
+      { N(0), B, P(0), P(1), P(2), P(3), P(4), P(5) },
+      { N(0), N(1), B, P(0), P(1), P(2), P(3), P(4) },
+      { N(0), N(1), N(2), B, P(0), P(1), P(2), P(3) },
+      { N(0), N(1), N(2), N(3), B, P(0), P(1), P(2) },
+      { N(0), N(1), N(2), N(3), N(4), B, P(0), P(1) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), B, P(0) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), B },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), N(7) }
+    }
+  },
+  { //5: previous digit drops down, new one is uncovered
+    8,
+    { 40, 40, 40, 40, 40, 40, 40, 40 },
+    {
+      { N(0), P(0), P(1), P(2), P(3), P(4), P(5), P(6) },
+      { N(0), N(1), P(0), P(1), P(2), P(3), P(4), P(5) },
+      { N(0), N(1), N(2), P(0), P(1), P(2), P(3), P(4) },
+      { N(0), N(1), N(2), N(3), P(0), P(1), P(2), P(3) },
+      { N(0), N(1), N(2), N(3), N(4), P(0), P(1), P(2) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), P(0), P(1) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), P(0) },
+      { N(0), N(1), N(2), N(3), N(4), N(5), N(6), N(7) }
+    }
+  }
+
+};
+
+#undef N
+#undef P
+#undef B
+
+const char TCAnimations::IDENTIFIER[] = "TA1";
+
+TCAnimations::Animation TCAnimations::customAnimations[TCAnimations::MAX_CUSTOM_ANIMATIONS];
+uint8_t TCAnimations::customAnimationCount = 0;
+
+uint8_t TCAnimations::getAnimationCount() {
+  return TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS + TCAnimations::customAnimationCount;
+}
+
+bool TCAnimations::getAnimation( uint8_t animationNumber, TCAnimations::Animation& animation ) {
+  if( animationNumber < 1 || animationNumber > TCAnimations::getAnimationCount() ) return false;
+  if( animationNumber <= TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS ) {
+    memcpy_P( &animation, &BUILT_IN_ANIMATIONS[animationNumber - 1], sizeof(animation) );
+  } else {
+    animation = TCAnimations::customAnimations[animationNumber - TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS - 1];
+  }
+  return true;
+}
+
+uint16_t TCAnimations::getAnimationLength( const TCAnimations::Animation& animation ) {
+  uint16_t animationLength = 0;
+  for( uint8_t step = 0; step < animation.steps; ++step ) {
+    animationLength += animation.stepDurations[step];
+  }
+  return animationLength;
+}
+
+uint8_t TCAnimations::getAnimationStep( const TCAnimations::Animation& animation, unsigned long animationMillis ) {
+  unsigned long stepEndMillis = 0;
+  for( uint8_t step = 0; step < animation.steps; ++step ) {
+    stepEndMillis += animation.stepDurations[step];
+    if( animationMillis < stepEndMillis ) return step;
+  }
+  return animation.steps > 0 ? animation.steps - 1 : 0;
+}
+
+unsigned long TCAnimations::getMillisUntilNextStep( const TCAnimations::Animation& animation, unsigned long animationMillis ) {
+  unsigned long stepEndMillis = 0;
+  for( uint8_t step = 0; step < animation.steps; ++step ) {
+    stepEndMillis += animation.stepDurations[step];
+    if( animationMillis < stepEndMillis ) return stepEndMillis - animationMillis;
+  }
+  return animationMillis <= stepEndMillis ? stepEndMillis + 1 - animationMillis : 0; //animation is over once its length is exceeded
+}
+
+bool TCAnimations::addCustomAnimation( const uint8_t* data, size_t dataSize ) {
+  if( TCAnimations::customAnimationCount >= TCAnimations::MAX_CUSTOM_ANIMATIONS ) return false;
+  if( dataSize < TCAnimations::IDENTIFIER_LENGTH + 1 || memcmp( data, TCAnimations::IDENTIFIER, TCAnimations::IDENTIFIER_LENGTH ) != 0 ) return false;
+
+  uint8_t steps = data[TCAnimations::IDENTIFIER_LENGTH];
+  if( steps < 1 || steps > TCAnimations::MAX_STEPS ) return false;
+  if( dataSize != (size_t)( TCAnimations::IDENTIFIER_LENGTH + 1 + steps * ( 1 + TCAnimations::ROW_COUNT ) ) ) return false;
+
+  TCAnimations::Animation& animation = TCAnimations::customAnimations[TCAnimations::customAnimationCount];
+  const uint8_t* stepDurations = &data[TCAnimations::IDENTIFIER_LENGTH + 1];
+  const uint8_t* rowSources = &stepDurations[steps];
+  for( uint8_t step = 0; step < steps; ++step ) {
+    if( stepDurations[step] == 0 ) return false;
+    for( uint8_t row = 0; row < TCAnimations::ROW_COUNT; ++row ) {
+      if( rowSources[step * TCAnimations::ROW_COUNT + row] >= TCAnimations::ROW_SOURCES ) return false;
+    }
+  }
+
+  memset( &animation, 0, sizeof(animation) );
+  animation.steps = steps;
+  memcpy( animation.stepDurations, stepDurations, steps );
+  memcpy( animation.rowSources, rowSources, steps * TCAnimations::ROW_COUNT );
+  TCAnimations::customAnimationCount++;
+  return true;
+}
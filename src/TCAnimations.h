@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+class TCAnimations { //registry of digit change animations: built-in descriptors in flash and custom ones loaded at boot
+
+  public:
+    static const uint8_t NUMBER_OF_BUILT_IN_ANIMATIONS = 5;
+    static const uint8_t MAX_CUSTOM_ANIMATIONS = 4;
+    static const uint8_t MAX_STEPS = 16;
+    static const uint8_t ROW_COUNT = 8;
+
+    //row source of an animated display row: new frame row 0..7, previous frame row ROW_PREVIOUS + 0..7, or ROW_BLANK
+    static const uint8_t ROW_PREVIOUS = ROW_COUNT;
+    static const uint8_t ROW_BLANK = 2 * ROW_COUNT;
+    static const uint8_t ROW_SOURCES = ROW_BLANK + 1;
+
+    //binary descriptor: identifier, step count, step durations in milliseconds, then ROW_COUNT row sources per step
+    static const char IDENTIFIER[];
+    static const uint8_t IDENTIFIER_LENGTH = 3;
+    static const uint16_t MAX_DATA_SIZE = IDENTIFIER_LENGTH + 1 + MAX_STEPS * ( 1 + ROW_COUNT );
+
+    struct Animation {
+      uint8_t steps;
+      uint8_t stepDurations[MAX_STEPS]; //timing curve, milliseconds each step is shown
+      uint8_t rowSources[MAX_STEPS][ROW_COUNT];
+    };
+
+    static uint8_t getAnimationCount();
+    static bool getAnimation( uint8_t animationNumber, Animation& animation ); //animation numbers start at 1, built-in ones go first
+    static uint16_t getAnimationLength( const Animation& animation );
+    static uint8_t getAnimationStep( const Animation& animation, unsigned long animationMillis ); //last step once the animation length is reached
+    static unsigned long getMillisUntilNextStep( const Animation& animation, unsigned long animationMillis ); //until the next step, or until the animation is over after the last one
+    static bool addCustomAnimation( const uint8_t* data, size_t dataSize ); //false when the descriptor is malformed or all custom slots are taken
+
+  private:
+    static Animation customAnimations[MAX_CUSTOM_ANIMATIONS];
+    static uint8_t customAnimationCount;
+
+};
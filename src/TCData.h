@@ -2,9 +2,7 @@
 
 class TCData {
   public:
-    static const uint8_t NUMBER_OF_ANIMATIONS_SUPPORTED = 5;
-
-    static const uint8_t* getAnimation( uint8_t index );
+    static const uint8_t* getAnimation( uint8_t index ); //preview of a built-in animation, transparent pixel for other indexes
     static const uint16_t getAnimationSize( uint8_t index );
 
     static const uint8_t* getFavIcon();
@@ -1,243 +1,96 @@
 #include "TCFonts.h"
 
-uint8_t TCFonts::getSymbolWidth( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
-  switch( fontIndex ) {
-    case 1:
-    case 2:
-    case 3:
-    case 4:
-    case 5: {
-      switch( isSmall ) {
-        case false: {
-          switch( symbol ) {
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '0':
-            case ' ':
-            case '-': {
-              switch( isWide ) {
-                case true: {
-                  return 6;
-                }
-                case false: {
-                  return 4;
-                }
-              }
-            }
-            case ':':
-            case '\b':
-            case '\f':
-            case '\t': {
-              switch( isWide ) {
-                case true: {
-                  return 1;
-                }
-                case false: {
-                  return 1;
-                }
-              }
-            }
-          }
-        }
-        case true: {
-          switch( isWide ) {
-            case false: {
-              switch( isCompact ) {
-                case false: {
-                  return 3;
-                }
-                case true: {
-                  return 4;
-                }
-              }
-            }
-          }
-        }
-      }
+//symbol metrics: left padding, image width and right padding in display columns
+//to add a font, append its metrics set to FONT_METRICS_SET; to add a glyph, assign it a symbol class in getSymbolClass()
+enum SymbolClass : uint8_t {
+  SYMBOL_CLASS_DIGIT, //digits, blank and minus
+  SYMBOL_CLASS_SEPARATOR, //colon and its blank/progress variants
+  SYMBOL_CLASS_OTHER, //unknown symbols keep the metrics they had in the former switch ladders (the small ones)
+  SYMBOL_CLASSES
+};
+
+static constexpr uint8_t getSymbolClass( char symbol ) {
+  return ( ( symbol >= '0' && symbol <= '9' ) || symbol == ' ' || symbol == '-' )
+         ? SYMBOL_CLASS_DIGIT
+         : ( ( symbol == ':' || symbol == '\b' || symbol == '\f' || symbol == '\t' )
+           ? SYMBOL_CLASS_SEPARATOR
+           : SYMBOL_CLASS_OTHER );
+}
+
+static constexpr uint8_t FONT_METRICS_SET[TCFonts::NUMBER_OF_FONTS_SUPPORTED] = { 0, 0, 0, 0, 0 };
+
+//indexed by [metrics set][symbol class][isSmall][isWide][isCompact]
+static constexpr TCFonts::SymbolMetrics SYMBOL_METRICS[1][SYMBOL_CLASSES][2][2][2] = {
+  { //metrics set 0
+    { //digit
+      { { { 0, 4, 1 }, { 0, 4, 1 } }, { { 1, 6, 0 }, { 1, 6, 0 } } }, //large: thin, wide
+      { { { 1, 3, 0 }, { 1, 4, 0 } }, { { 0, 0, 0 }, { 0, 0, 0 } } }  //small: thin, wide
+    },
+    { //separator
+      { { { 1, 1, 2 }, { 0, 1, 1 } }, { { 2, 1, 1 }, { 1, 1, 0 } } },
+      { { { 1, 3, 0 }, { 1, 4, 0 } }, { { 0, 0, 0 }, { 0, 0, 0 } } }
+    },
+    { //other
+      { { { 1, 3, 0 }, { 1, 4, 0 } }, { { 0, 0, 0 }, { 0, 0, 0 } } },
+      { { { 1, 3, 0 }, { 1, 4, 0 } }, { { 0, 0, 0 }, { 0, 0, 0 } } }
     }
   }
-  return 0;
+};
+
+static constexpr TCFonts::SymbolMetrics lookupSymbolMetrics( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
+  return ( fontIndex >= 1 && fontIndex <= TCFonts::NUMBER_OF_FONTS_SUPPORTED )
+         ? SYMBOL_METRICS[FONT_METRICS_SET[fontIndex - 1]][getSymbolClass( symbol )][isSmall][isWide][isCompact]
+         : TCFonts::SymbolMetrics{ 0, 0, 0 };
+}
+
+//the values the former nested switch ladders returned, kept to prove the tables at compile time
+static constexpr TCFonts::SymbolMetrics getLegacySymbolMetrics( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
+  return !( fontIndex >= 1 && fontIndex <= 5 )
+         ? TCFonts::SymbolMetrics{ 0, 0, 0 }
+         : ( ( !isSmall && getSymbolClass( symbol ) == SYMBOL_CLASS_DIGIT )
+           ? TCFonts::SymbolMetrics{ static_cast<uint8_t>( isWide ? 1 : 0 ), static_cast<uint8_t>( isWide ? 6 : 4 ), static_cast<uint8_t>( isWide ? 0 : 1 ) }
+           : ( ( !isSmall && getSymbolClass( symbol ) == SYMBOL_CLASS_SEPARATOR )
+             ? TCFonts::SymbolMetrics{ static_cast<uint8_t>( ( isCompact ? 0 : 1 ) + ( isWide ? 1 : 0 ) ), 1, static_cast<uint8_t>( ( isCompact ? 1 : 2 ) - ( isWide ? 1 : 0 ) ) }
+             : TCFonts::SymbolMetrics{ static_cast<uint8_t>( isWide ? 0 : 1 ), static_cast<uint8_t>( isWide ? 0 : ( isCompact ? 4 : 3 ) ), 0 } ) );
+}
+
+static constexpr bool isSymbolMetricsEqual( const TCFonts::SymbolMetrics& a, const TCFonts::SymbolMetrics& b ) {
+  return a.lp == b.lp && a.width == b.width && a.rp == b.rp;
+}
+
+static constexpr char SYMBOLS_CHECKED[] = "0123456789 -:\b\f\tA";
+
+static constexpr uint16_t SYMBOL_METRICS_COMBINATIONS = 7 * ( sizeof(SYMBOLS_CHECKED) - 1 ) * 8; //fonts 0..6 x checked symbols x compact/wide/small
+
+static constexpr bool isSymbolMetricsCombinationValid( uint16_t combination ) {
+  return isSymbolMetricsEqual(
+    lookupSymbolMetrics( combination / 8 / ( sizeof(SYMBOLS_CHECKED) - 1 ), SYMBOLS_CHECKED[combination / 8 % ( sizeof(SYMBOLS_CHECKED) - 1 )], combination & 1, combination & 2, combination & 4 ),
+    getLegacySymbolMetrics( combination / 8 / ( sizeof(SYMBOLS_CHECKED) - 1 ), SYMBOLS_CHECKED[combination / 8 % ( sizeof(SYMBOLS_CHECKED) - 1 )], combination & 1, combination & 2, combination & 4 )
+  );
+}
+
+static constexpr bool isSymbolMetricsTableValid( uint16_t from, uint16_t count ) { //halves the range to keep constexpr recursion shallow
+  return count == 1
+         ? isSymbolMetricsCombinationValid( from )
+         : ( isSymbolMetricsTableValid( from, count / 2 ) && isSymbolMetricsTableValid( from + count / 2, count - count / 2 ) );
+}
+
+static_assert( isSymbolMetricsTableValid( 0, SYMBOL_METRICS_COMBINATIONS ), "Symbol metrics table does not match the legacy symbol metrics" );
+
+TCFonts::SymbolMetrics TCFonts::getSymbolMetrics( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
+  return lookupSymbolMetrics( fontIndex, symbol, isCompact, isWide, isSmall );
+}
+
+uint8_t TCFonts::getSymbolWidth( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
+  return lookupSymbolMetrics( fontIndex, symbol, isCompact, isWide, isSmall ).width;
 }
 
 uint8_t TCFonts::getSymbolLp( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
-  switch( fontIndex ) {
-    case 1:
-    case 2:
-    case 3:
-    case 4:
-    case 5: {
-      switch( isSmall ) {
-        case false: {
-          switch( symbol ) {
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '0':
-            case ' ':
-            case '-': {
-              switch( isCompact ) {
-                case false: {
-                  switch( isWide ) {
-                    case false: {
-                      return 0;
-                    }
-                    case true: {
-                      return 1;
-                    }
-                  }
-                }
-                case true: {
-                  switch( isWide ) {
-                    case false: {
-                      return 0;
-                    }
-                    case true: {
-                      return 1;
-                    }
-                  }
-                }
-              }
-            }
-            case ':':
-            case '\b':
-            case '\f':
-            case '\t': {
-              switch( isCompact ) {
-                case false: {
-                  switch( isWide ) {
-                    case false: {
-                      return 1;
-                    }
-                    case true: {
-                      return 2;
-                    }
-                  }
-                }
-                case true: {
-                  switch( isWide ) {
-                    case false: {
-                      return 0;
-                    }
-                    case true: {
-                      return 1;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-        case true: {
-          switch( isWide ) {
-            case false: {
-              return 1;
-            }
-          }
-        }
-      }
-    }
-  }
-  return 0;
+  return lookupSymbolMetrics( fontIndex, symbol, isCompact, isWide, isSmall ).lp;
 }
 
 uint8_t TCFonts::getSymbolRp( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall ) {
-  switch( fontIndex ) {
-    case 1:
-    case 2:
-    case 3:
-    case 4:
-    case 5: {
-      switch( isSmall ) {
-        case false: {
-          switch( symbol ) {
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '0':
-            case ' ':
-            case '-': {
-              switch( isCompact ) {
-                case false: {
-                  switch( isWide ) {
-                    case false: {
-                      return 1;
-                    }
-                    case true: {
-                      return 0;
-                    }
-                  }
-                }
-                case true: {
-                  switch( isWide ) {
-                    case false: {
-                      return 1;
-                    }
-                    case true: {
-                      return 0;
-                    }
-                  }
-                }
-              }
-            }
-            case ':':
-            case '\b':
-            case '\f':
-            case '\t': {
-              switch( isCompact ) {
-                case false: {
-                  switch( isWide ) {
-                    case false: {
-                      return 2;
-                    }
-                    case true: {
-                      return 1;
-                    }
-                  }
-                }
-                case true: {
-                  switch( isWide ) {
-                    case false: {
-                      return 1;
-                    }
-                    case true: {
-                      return 0;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-        case true: {
-          switch( isWide ) {
-            case false: {
-              return 0;
-            }
-          }
-        }
-      }
-    }
-  }
-  return 0;
+  return lookupSymbolMetrics( fontIndex, symbol, isCompact, isWide, isSmall ).rp;
 }
 
 
@@ -257,31 +110,52 @@ std::pair<const uint8_t (*)[TCFonts::FONT_HEIGHT], bool> TCFonts::getFont(uint8_
     }
 }
 
-std::map<char, uint8_t> TCFonts::charToCharIndex = {
-  { '1', 0 },
-  { '2', 1 },
-  { '3', 2 },
-  { '4', 3 },
-  { '5', 4 },
-  { '6', 5 },
-  { '7', 6 },
-  { '8', 7 },
-  { '9', 8 },
-  { '0', 9 },
-  { '-', 10 },
-  { ':', 11 },
-  { '\b', 12 },
-  { '\f', 13 },
-};
+//font symbol order: the symbol at position N occupies font rows N*16..N*16+15
+static constexpr char FONT_SYMBOL_LIST[] = "1234567890-:\b\f";
+
+static_assert( TCFonts::SYMBOL_COUNT == sizeof(FONT_SYMBOL_LIST) - 1, "Font symbol list does not match the font size" );
 
-std::vector<uint8_t> TCFonts::getSymbol( uint8_t fontIndex, char symbol, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress ) {
+static constexpr uint8_t findSymbolIndex( char symbol, uint8_t position ) {
+  return position >= sizeof(FONT_SYMBOL_LIST) - 1
+         ? TCFonts::UNKNOWN_SYMBOL_INDEX
+         : ( FONT_SYMBOL_LIST[position] == symbol ? position : findSymbolIndex( symbol, position + 1 ) );
+}
+
+#define SYMBOL_INDEX_1(c) findSymbolIndex( static_cast<char>( c ), 0 )
+#define SYMBOL_INDEX_4(c) SYMBOL_INDEX_1(c), SYMBOL_INDEX_1((c)+1), SYMBOL_INDEX_1((c)+2), SYMBOL_INDEX_1((c)+3)
+#define SYMBOL_INDEX_16(c) SYMBOL_INDEX_4(c), SYMBOL_INDEX_4((c)+4), SYMBOL_INDEX_4((c)+8), SYMBOL_INDEX_4((c)+12)
+#define SYMBOL_INDEX_64(c) SYMBOL_INDEX_16(c), SYMBOL_INDEX_16((c)+16), SYMBOL_INDEX_16((c)+32), SYMBOL_INDEX_16((c)+48)
+#define SYMBOL_INDEX_256(c) SYMBOL_INDEX_64(c), SYMBOL_INDEX_64((c)+64), SYMBOL_INDEX_64((c)+128), SYMBOL_INDEX_64((c)+192)
+
+//char to font symbol position, indexed by unsigned char; TCFonts::UNKNOWN_SYMBOL_INDEX for chars without a glyph
+static constexpr uint8_t charToCharIndex[256] PROGMEM = { SYMBOL_INDEX_256(0) };
+
+#undef SYMBOL_INDEX_256
+#undef SYMBOL_INDEX_64
+#undef SYMBOL_INDEX_16
+#undef SYMBOL_INDEX_4
+#undef SYMBOL_INDEX_1
+
+static_assert( charToCharIndex[static_cast<uint8_t>( '1' )] == 0 && charToCharIndex[static_cast<uint8_t>( '0' )] == 9 && charToCharIndex[static_cast<uint8_t>( '\f' )] == 13, "Char to symbol index table is out of order" );
+static_assert( charToCharIndex[static_cast<uint8_t>( ' ' )] == TCFonts::UNKNOWN_SYMBOL_INDEX && charToCharIndex[0xFF] == TCFonts::UNKNOWN_SYMBOL_INDEX, "Char to symbol index table maps unknown chars" );
+
+uint8_t TCFonts::getSymbolIndex( char symbol ) {
+  return pgm_read_byte( &charToCharIndex[static_cast<uint8_t>( symbol )] );
+}
+
+TCFonts::Symbol TCFonts::getSymbol( uint8_t fontIndex, char symbol, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress ) {
+  return TCFonts::getSymbolAt( fontIndex, TCFonts::getSymbolIndex( symbol ), isCompact, isBold, isWide, isSmall, isProgress );
+}
+
+TCFonts::Symbol TCFonts::getSymbolAt( uint8_t fontIndex, uint8_t symbolIndex, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress ) {
   std::pair<const uint8_t (*)[TCFonts::FONT_HEIGHT], bool> fontInfo = TCFonts::getFont(fontIndex);
   const uint8_t (*fontToUse)[TCFonts::FONT_HEIGHT] = fontInfo.first;
   bool isCustomFont = fontInfo.second;
 
-  auto charPositionIt = TCFonts::charToCharIndex.find( symbol );
-  if( charPositionIt == TCFonts::charToCharIndex.end() ) {
-    return { 0, 0, 0, 0, 0, 0, 0, 0 };
+  TCFonts::Symbol symbolToUse;
+  if( symbolIndex >= TCFonts::SYMBOL_COUNT ) {
+    memset( symbolToUse.lines, 0, sizeof(symbolToUse.lines) );
+    return symbolToUse;
   }
 
   //  0 big    normal    wide
@@ -300,7 +174,7 @@ std::vector<uint8_t> TCFonts::getSymbol( uint8_t fontIndex, char symbol, bool is
   // 13 small  progress  wider  bold
   // 14 small  progress  thin
   // 15 small  progress  thin   bold
-  uint16_t charPosition = charPositionIt->second;
+  uint16_t charPosition = symbolIndex;
   charPosition *= 16;
   if( isSmall ) {
     charPosition += 8;
@@ -315,15 +189,10 @@ std::vector<uint8_t> TCFonts::getSymbol( uint8_t fontIndex, char symbol, bool is
     charPosition += 1;
   }
 
-  std::vector<uint8_t> symbolToUse;
-  for( uint8_t symbolLineIndex = 0; symbolLineIndex < TCFonts::FONT_HEIGHT; symbolLineIndex++ ) {
-    uint8_t symbolLine;
-    if( isCustomFont ) {
-      symbolLine = fontToUse[charPosition][symbolLineIndex];
-    } else {
-      symbolLine = pgm_read_byte( &(fontToUse[charPosition][symbolLineIndex]) );
-    }
-    symbolToUse.push_back( symbolLine );
+  if( isCustomFont ) {
+    memcpy( symbolToUse.lines, fontToUse[charPosition], TCFonts::FONT_HEIGHT );
+  } else {
+    memcpy_P( symbolToUse.lines, fontToUse[charPosition], TCFonts::FONT_HEIGHT );
   }
 
   return symbolToUse;
@@ -1,6 +1,7 @@
+#pragma once
+
 #include <Arduino.h>
-#include <vector>
-#include <map>
+#include <utility>
 
 #include "TCFont1.h"
 #include "TCFont2.h"
@@ -13,16 +14,30 @@ class TCFonts {
     static const uint8_t NUMBER_OF_FONTS_SUPPORTED = 5;
     static const uint8_t FONT_HEIGHT = 8;
     static const uint16_t FONT_SYMBOLS = 16*14;
+    static const uint8_t SYMBOL_COUNT = FONT_SYMBOLS / 16; //distinct symbols, each stored in 16 style variants
+    static const uint8_t UNKNOWN_SYMBOL_INDEX = 0xFF;
+
+    struct SymbolMetrics {
+      uint8_t lp; //left padding
+      uint8_t width;
+      uint8_t rp; //right padding
+    };
+
+    struct Symbol { //symbol image copied out of the font, one byte per line; returned by value so no heap allocation is needed
+      uint8_t lines[FONT_HEIGHT];
+    };
 
+    static SymbolMetrics getSymbolMetrics( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall );
     static uint8_t getSymbolWidth( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall );
     static uint8_t getSymbolLp( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall );
     static uint8_t getSymbolRp( uint8_t fontIndex, char symbol, bool isCompact, bool isWide, bool isSmall );
     static std::pair<const uint8_t (*)[TCFonts::FONT_HEIGHT], bool> getFont( uint8_t fontIndex );
-    static std::vector<uint8_t> getSymbol( uint8_t fontIndex, char symbol, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress );
+    static uint8_t getSymbolIndex( char symbol ); //UNKNOWN_SYMBOL_INDEX when the font has no glyph for the char
+    static Symbol getSymbol( uint8_t fontIndex, char symbol, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress );
+    static Symbol getSymbolAt( uint8_t fontIndex, uint8_t symbolIndex, bool isCompact, bool isBold, bool isWide, bool isSmall, bool isProgress );
     static uint8_t (*getCustomFont())[TCFonts::FONT_HEIGHT];
     static void setCustomFont( uint8_t (*fontToUse)[TCFonts::FONT_HEIGHT] );
 
   private:
-    static std::map<char, uint8_t> charToCharIndex;
     static uint8_t customFont[TCFonts::FONT_SYMBOLS][TCFonts::FONT_HEIGHT];
 };
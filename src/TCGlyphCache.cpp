@@ -0,0 +1,34 @@
+#include "TCGlyphCache.h"
+
+const TCFonts::Symbol TCGlyphCache::blankSymbol = {};
+
+const TCFonts::Symbol& TCGlyphCache::getSymbol( const TCLayoutStyle& style, char symbol, bool isSmall ) {
+  if( !isCachedStyle( style ) ) {
+    rebuild( style );
+  }
+  uint8_t symbolIndex = TCFonts::getSymbolIndex( symbol );
+  if( symbolIndex == TCFonts::UNKNOWN_SYMBOL_INDEX ) return blankSymbol;
+  return symbols[symbolIndex][isSmall ? 1 : 0];
+}
+
+void TCGlyphCache::invalidate() {
+  isValid = false;
+}
+
+bool TCGlyphCache::isCachedStyle( const TCLayoutStyle& style ) const {
+  return isValid
+      && cachedStyle.fontIndex == style.fontIndex
+      && cachedStyle.isCompact == style.isCompact
+      && cachedStyle.isBold == style.isBold
+      && cachedStyle.isWide == style.isWide;
+}
+
+void TCGlyphCache::rebuild( const TCLayoutStyle& style ) {
+  for( uint8_t symbolIndex = 0; symbolIndex < TCFonts::SYMBOL_COUNT; ++symbolIndex ) {
+    for( uint8_t isSmall = 0; isSmall < 2; ++isSmall ) {
+      symbols[symbolIndex][isSmall] = TCFonts::getSymbolAt( style.fontIndex, symbolIndex, style.isCompact, style.isBold, style.isWide, isSmall, false );
+    }
+  }
+  cachedStyle = style;
+  isValid = true;
+}
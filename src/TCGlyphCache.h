@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "TCFonts.h"
+#include "TCLayout.h"
+
+class TCGlyphCache { //images of every font symbol in one layout style, so rendering does not decode the font each frame
+
+  public:
+    const TCFonts::Symbol& getSymbol( const TCLayoutStyle& style, char symbol, bool isSmall ); //rebuilds the cache when the style differs from the cached one
+    void invalidate(); //font bitmaps changed without a style change, e.g. a custom font was uploaded
+
+  private:
+    bool isValid = false;
+    TCLayoutStyle cachedStyle;
+    TCFonts::Symbol symbols[TCFonts::SYMBOL_COUNT][2]; //[symbol index][isSmall]
+    static const TCFonts::Symbol blankSymbol;
+
+    bool isCachedStyle( const TCLayoutStyle& style ) const;
+    void rebuild( const TCLayoutStyle& style );
+
+};
@@ -0,0 +1,76 @@
+#include "TCLayout.h"
+
+void TCRowCanvas::drawBlank( uint8_t x, uint8_t width ) {
+  uint32_t columnsMask = getColumnsMask( x, width );
+  for( uint8_t displayY = 0; displayY < TCLayout::DISPLAY_HEIGHT; ++displayY ) {
+    rows[displayY] &= ~columnsMask;
+  }
+}
+
+void TCRowCanvas::drawSymbol( const TCLayoutStyle& style, const TCGlyphPlacement& placement ) {
+  drawSymbolLines( rows, TCFonts::getSymbol( style.fontIndex, placement.symbol, style.isCompact, style.isBold, style.isWide, placement.isSmall, false ), placement );
+}
+
+uint32_t TCRowCanvas::getColumnsMask( uint8_t x, uint8_t width ) {
+  if( width == 0 ) return 0;
+  return ( 0xFFFFFFFF << ( TCLayout::DISPLAY_WIDTH - width ) ) >> x;
+}
+
+void TCRowCanvas::drawSymbolLines( uint32_t* rows, const TCFonts::Symbol& charImage, const TCGlyphPlacement& placement ) { //bit 7 of a font line is the leftmost symbol column
+  uint32_t columnsMask = getColumnsMask( placement.x, placement.width );
+  uint8_t charShiftY = TCLayout::DISPLAY_HEIGHT - TCFonts::FONT_HEIGHT;
+  for( uint8_t charY = 0; charY < TCFonts::FONT_HEIGHT; ++charY ) {
+    uint32_t charLine = ( static_cast<uint32_t>( charImage.lines[charY] ) << ( TCLayout::DISPLAY_WIDTH - 8 ) ) >> placement.x;
+    rows[charY + charShiftY] = ( rows[charY + charShiftY] & ~columnsMask ) | ( charLine & columnsMask );
+  }
+}
+
+
+void TCLayout::render( TCCanvas& canvas, const TCLayoutStyle& style, const String& textLarge, const String& textSmall, bool isSecondsShown ) {
+  uint8_t displayWidthUsed = 0;
+  renderText( canvas, style, textLarge, false, displayWidthUsed );
+  if( isSecondsShown ) {
+    renderText( canvas, style, textSmall, true, displayWidthUsed );
+  }
+
+  if( displayWidthUsed < DISPLAY_WIDTH ) { //fill the rest of the screen
+    canvas.drawBlank( displayWidthUsed, DISPLAY_WIDTH - displayWidthUsed );
+  }
+}
+
+void TCLayout::renderText( TCCanvas& canvas, const TCLayoutStyle& style, const String& text, bool isSmall, uint8_t& displayWidthUsed ) {
+  for( size_t charToDisplayIndex = 0; charToDisplayIndex < text.length(); ++charToDisplayIndex ) {
+    char charToDisplay = text.charAt( charToDisplayIndex );
+
+    TCFonts::SymbolMetrics charMetrics = TCFonts::getSymbolMetrics( style.fontIndex, charToDisplay, style.isCompact, style.isWide, isSmall );
+    uint8_t charLpWidth = charMetrics.lp;
+    uint8_t charWidth = charMetrics.width;
+    uint8_t charRpWidth = charMetrics.rp;
+
+    if( displayWidthUsed + charLpWidth > DISPLAY_WIDTH ) {
+      charLpWidth = DISPLAY_WIDTH - displayWidthUsed;
+    }
+    if( displayWidthUsed + charLpWidth + charWidth > DISPLAY_WIDTH ) {
+      charWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth;
+    }
+    if( displayWidthUsed + charLpWidth + charWidth + charRpWidth > DISPLAY_WIDTH ) {
+      charRpWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth - charWidth;
+    }
+
+    if( charWidth == 0 ) continue;
+
+    if( charLpWidth > 0 ) {
+      canvas.drawBlank( displayWidthUsed, charLpWidth );
+      displayWidthUsed += charLpWidth;
+    }
+
+    TCGlyphPlacement placement = { charToDisplay, static_cast<uint8_t>( charToDisplayIndex ), isSmall, displayWidthUsed, charWidth };
+    canvas.drawSymbol( style, placement );
+    displayWidthUsed += charWidth;
+
+    if( charRpWidth > 0 ) {
+      canvas.drawBlank( displayWidthUsed, charRpWidth );
+      displayWidthUsed += charRpWidth;
+    }
+  }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "TCFonts.h"
+
+struct TCLayoutStyle {
+  uint8_t fontIndex;
+  bool isCompact;
+  bool isBold;
+  bool isWide;
+};
+
+struct TCGlyphPlacement {
+  char symbol;
+  uint8_t textIndex; //position of the symbol in the large or small text
+  bool isSmall;
+  uint8_t x; //first display column of the symbol image
+  uint8_t width; //number of visible symbol image columns, may be clipped by the display edge
+};
+
+class TCCanvas { //target of TCLayout; columns are numbered from left to right
+
+  public:
+    virtual void drawBlank( uint8_t x, uint8_t width ) = 0;
+    virtual void drawSymbol( const TCLayoutStyle& style, const TCGlyphPlacement& placement ) = 0;
+
+};
+
+class TCRowCanvas : public TCCanvas { //packed row bitmap: one 32-bit word per row, bit 31 is the leftmost column
+
+  public:
+    TCRowCanvas( uint32_t* rows ) : rows( rows ) {}
+    void drawBlank( uint8_t x, uint8_t width ) override;
+    void drawSymbol( const TCLayoutStyle& style, const TCGlyphPlacement& placement ) override;
+
+    static uint32_t getColumnsMask( uint8_t x, uint8_t width );
+    static void drawSymbolLines( uint32_t* rows, const TCFonts::Symbol& charImage, const TCGlyphPlacement& placement );
+
+  protected:
+    uint32_t* rows;
+
+};
+
+class TCLayout {
+
+  public:
+    static const uint8_t DISPLAY_WIDTH = 32;
+    static const uint8_t DISPLAY_HEIGHT = 8;
+    static_assert( DISPLAY_WIDTH == 32, "Display rows are packed into 32-bit words" );
+
+    static void render( TCCanvas& canvas, const TCLayoutStyle& style, const String& textLarge, const String& textSmall, bool isSecondsShown );
+
+  private:
+    static void renderText( TCCanvas& canvas, const TCLayoutStyle& style, const String& text, bool isSmall, uint8_t& displayWidthUsed );
+
+};
@@ -0,0 +1,144 @@
+#include "TCScheduler.h"
+
+#include <limits.h>
+
+//deadlines are compared through their signed difference, which stays correct when millis() overflows
+//as long as all deadlines are within 24 days of each other
+static bool isDeadlineReached( unsigned long deadlineMillis, unsigned long currentMillis ) {
+  return static_cast<long>( currentMillis - deadlineMillis ) >= 0;
+}
+
+uint8_t TCScheduler::addPeriodicTask( const char* name, TaskCallback callback, unsigned long periodMillis, unsigned long firstDelayMillis ) {
+  return addTask( name, callback, periodMillis, firstDelayMillis );
+}
+
+uint8_t TCScheduler::addOneShotTask( const char* name, TaskCallback callback, unsigned long delayMillis ) {
+  return addTask( name, callback, 0, delayMillis );
+}
+
+uint8_t TCScheduler::addTask( const char* name, TaskCallback callback, unsigned long periodMillis, unsigned long delayMillis ) {
+  if( taskCount >= MAX_TASKS ) return INVALID_TASK_ID;
+  uint8_t taskId = taskCount++;
+  Task& task = tasks[taskId];
+  task.callback = callback;
+  task.periodMillis = periodMillis;
+  task.deadlineMillis = millis() + delayMillis;
+  task.heapIndex = INVALID_TASK_ID;
+  task.stats = { name, 0, 0, 0 };
+  pushTask( taskId );
+  return taskId;
+}
+
+void TCScheduler::rescheduleTask( uint8_t taskId, unsigned long delayMillis ) {
+  if( taskId >= taskCount ) return;
+  removeTask( taskId );
+  tasks[taskId].deadlineMillis = millis() + delayMillis;
+  pushTask( taskId );
+}
+
+void TCScheduler::cancelTask( uint8_t taskId ) {
+  if( taskId >= taskCount ) return;
+  removeTask( taskId );
+}
+
+uint8_t TCScheduler::run() {
+  uint8_t tasksRun = 0;
+  uint8_t tasksToRun = heapSize; //tasks rescheduled while running are not run again in this call
+  while( tasksToRun-- > 0 && heapSize > 0 ) {
+    unsigned long currentMillis = millis();
+    uint8_t taskId = heap[0];
+    Task& task = tasks[taskId];
+    if( !isDeadlineReached( task.deadlineMillis, currentMillis ) ) break;
+
+    removeTask( taskId );
+    if( task.periodMillis > 0 ) { //periodic tasks keep their cadence, unless they fell behind by a whole period
+      task.deadlineMillis += task.periodMillis;
+      if( isDeadlineReached( task.deadlineMillis, currentMillis ) ) {
+        task.deadlineMillis = currentMillis + task.periodMillis;
+      }
+      pushTask( taskId );
+    }
+
+    unsigned long runStartedMicros = micros();
+    task.callback();
+    tasksRun++;
+    uint32_t runMicros = micros() - runStartedMicros;
+    task.stats.runs++;
+    task.stats.runMicros += runMicros;
+    if( runMicros > task.stats.maxRunMicros ) {
+      task.stats.maxRunMicros = runMicros;
+    }
+  }
+  return tasksRun;
+}
+
+unsigned long TCScheduler::getMillisUntilNextTask() {
+  if( heapSize == 0 ) return ULONG_MAX;
+  unsigned long currentMillis = millis();
+  unsigned long deadlineMillis = tasks[heap[0]].deadlineMillis;
+  return isDeadlineReached( deadlineMillis, currentMillis ) ? 0 : deadlineMillis - currentMillis;
+}
+
+uint8_t TCScheduler::getTaskCount() const {
+  return taskCount;
+}
+
+const TCScheduler::TaskStats& TCScheduler::getTaskStats( uint8_t taskId ) const {
+  return tasks[taskId].stats;
+}
+
+bool TCScheduler::isEarlier( uint8_t taskIdA, uint8_t taskIdB ) const {
+  return static_cast<long>( tasks[taskIdA].deadlineMillis - tasks[taskIdB].deadlineMillis ) < 0;
+}
+
+void TCScheduler::swapHeapItems( uint8_t heapIndexA, uint8_t heapIndexB ) {
+  uint8_t taskIdA = heap[heapIndexA];
+  heap[heapIndexA] = heap[heapIndexB];
+  heap[heapIndexB] = taskIdA;
+  tasks[heap[heapIndexA]].heapIndex = heapIndexA;
+  tasks[heap[heapIndexB]].heapIndex = heapIndexB;
+}
+
+void TCScheduler::siftUp( uint8_t heapIndex ) {
+  while( heapIndex > 0 ) {
+    uint8_t parentIndex = ( heapIndex - 1 ) / 2;
+    if( !isEarlier( heap[heapIndex], heap[parentIndex] ) ) break;
+    swapHeapItems( heapIndex, parentIndex );
+    heapIndex = parentIndex;
+  }
+}
+
+void TCScheduler::siftDown( uint8_t heapIndex ) {
+  while( true ) {
+    uint8_t earliestIndex = heapIndex;
+    uint8_t leftIndex = 2 * heapIndex + 1;
+    uint8_t rightIndex = leftIndex + 1;
+    if( leftIndex < heapSize && isEarlier( heap[leftIndex], heap[earliestIndex] ) ) earliestIndex = leftIndex;
+    if( rightIndex < heapSize && isEarlier( heap[rightIndex], heap[earliestIndex] ) ) earliestIndex = rightIndex;
+    if( earliestIndex == heapIndex ) break;
+    swapHeapItems( heapIndex, earliestIndex );
+    heapIndex = earliestIndex;
+  }
+}
+
+void TCScheduler::pushTask( uint8_t taskId ) {
+  if( tasks[taskId].heapIndex != INVALID_TASK_ID ) return;
+  uint8_t heapIndex = heapSize++;
+  heap[heapIndex] = taskId;
+  tasks[taskId].heapIndex = heapIndex;
+  siftUp( heapIndex );
+}
+
+void TCScheduler::removeTask( uint8_t taskId ) {
+  uint8_t heapIndex = tasks[taskId].heapIndex;
+  if( heapIndex == INVALID_TASK_ID ) return;
+  uint8_t lastIndex = --heapSize;
+  if( heapIndex != lastIndex ) {
+    swapHeapItems( heapIndex, lastIndex );
+  }
+  tasks[taskId].heapIndex = INVALID_TASK_ID;
+  if( heapIndex < heapSize ) {
+    siftDown( heapIndex );
+    siftUp( heapIndex );
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+class TCScheduler { //cooperative scheduler: timed tasks kept in a min-heap by deadline and run from loop()
+
+  public:
+    typedef void (*TaskCallback)();
+
+    static const uint8_t MAX_TASKS = 12;
+    static const uint8_t INVALID_TASK_ID = 0xFF;
+
+    struct TaskStats {
+      const char* name;
+      uint32_t runs;
+      uint32_t runMicros; //total time spent in the task callback
+      uint32_t maxRunMicros;
+    };
+
+    uint8_t addPeriodicTask( const char* name, TaskCallback callback, unsigned long periodMillis, unsigned long firstDelayMillis );
+    uint8_t addOneShotTask( const char* name, TaskCallback callback, unsigned long delayMillis ); //the task slot is kept, so rescheduleTask() may run it again
+    void rescheduleTask( uint8_t taskId, unsigned long delayMillis ); //next run is delayMillis from now
+    void cancelTask( uint8_t taskId );
+    uint8_t run(); //runs every task that is due, each one at most once per call; returns the number of tasks run
+    unsigned long getMillisUntilNextTask();
+
+    uint8_t getTaskCount() const;
+    const TaskStats& getTaskStats( uint8_t taskId ) const;
+
+  private:
+    struct Task {
+      TaskCallback callback;
+      unsigned long periodMillis; //0 for one-shot tasks
+      unsigned long deadlineMillis;
+      uint8_t heapIndex; //INVALID_TASK_ID while the task is not scheduled
+      TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount = 0;
+    uint8_t heap[MAX_TASKS]; //task ids, the task with the earliest deadline first
+    uint8_t heapSize = 0;
+
+    uint8_t addTask( const char* name, TaskCallback callback, unsigned long periodMillis, unsigned long delayMillis );
+    bool isEarlier( uint8_t taskIdA, uint8_t taskIdB ) const;
+    void swapHeapItems( uint8_t heapIndexA, uint8_t heapIndexB );
+    void siftUp( uint8_t heapIndex );
+    void siftDown( uint8_t heapIndex );
+    void pushTask( uint8_t taskId );
+    void removeTask( uint8_t taskId );
+
+};
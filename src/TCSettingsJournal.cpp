@@ -0,0 +1,228 @@
+#include "TCSettingsJournal.h"
+
+TCSettingsJournal::TCSettingsJournal( const char* pathA, const char* pathB, uint32_t compactionSize ) : compactionSize( compactionSize ) {
+  paths[0] = pathA;
+  paths[1] = pathB;
+}
+
+uint32_t TCSettingsJournal::updateCrc32( uint32_t crc, const uint8_t* data, uint16_t length ) { //CRC-32/ISO-HDLC, a nibble at a time; start with 0 for a new CRC
+  static const uint32_t NIBBLE_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  crc = ~crc;
+  for( uint16_t i = 0; i < length; i++ ) {
+    crc = NIBBLE_TABLE[( crc ^ data[i] ) & 0x0F] ^ ( crc >> 4 );
+    crc = NIBBLE_TABLE[( crc ^ ( data[i] >> 4 ) ) & 0x0F] ^ ( crc >> 4 );
+  }
+  return ~crc;
+}
+
+uint32_t TCSettingsJournal::readUint32( const uint8_t* data ) {
+  return (uint32_t)data[0] | ( (uint32_t)data[1] << 8 ) | ( (uint32_t)data[2] << 16 ) | ( (uint32_t)data[3] << 24 );
+}
+
+void TCSettingsJournal::writeUint32( uint8_t* data, uint32_t value ) {
+  data[0] = value & 0xFF;
+  data[1] = ( value >> 8 ) & 0xFF;
+  data[2] = ( value >> 16 ) & 0xFF;
+  data[3] = value >> 24;
+}
+
+bool TCSettingsJournal::readGeneration( uint8_t fileIndex, uint32_t& generation ) {
+  if( !LittleFS.exists( paths[fileIndex] ) ) return false;
+  File file = LittleFS.open( paths[fileIndex], "r" );
+  if( !file ) return false;
+  uint8_t header[HEADER_SIZE];
+  bool isRead = file.read( header, HEADER_SIZE ) == HEADER_SIZE;
+  file.close();
+  if( !isRead || readUint32( header ) != FILE_MAGIC || readUint32( header + 8 ) != updateCrc32( 0, header, 8 ) ) return false;
+  generation = readUint32( header + 4 );
+  return true;
+}
+
+TCSettingsJournal::LoadResult TCSettingsJournal::load( uint8_t fileIndex, uint32_t endPosition ) {
+  LoadResult result = {};
+  memset( image, 0xFF, imageSize ); //same as an erased EEPROM
+  stats.recordsLoaded = 0;
+  File file = LittleFS.open( paths[fileIndex], "r" );
+  if( !file ) return result;
+  file.seek( HEADER_SIZE );
+
+  result.isTailValid = true;
+  uint32_t position = HEADER_SIZE;
+  while( position < endPosition && file.available() > 0 ) {
+    uint8_t record[RECORD_HEADER_SIZE + RECORD_DATA_MAX + RECORD_CRC_SIZE];
+    if( file.read( record, RECORD_HEADER_SIZE ) != RECORD_HEADER_SIZE || ( record[0] != RECORD_MARKER && record[0] != RECORD_MARKER_GROUP_END ) ) {
+      result.isTailValid = false;
+      break;
+    }
+    uint16_t offset = (uint16_t)record[1] | ( (uint16_t)record[2] << 8 );
+    uint8_t length = record[3];
+    uint16_t remainingSize = length + RECORD_CRC_SIZE;
+    if( length == 0 || file.read( record + RECORD_HEADER_SIZE, remainingSize ) != remainingSize ) { //record was cut off by a power loss
+      result.isTailValid = false;
+      break;
+    }
+    if( readUint32( record + RECORD_HEADER_SIZE + length ) != updateCrc32( 0, record, RECORD_HEADER_SIZE + length ) ) {
+      result.isTailValid = false;
+      break;
+    }
+    if( offset < imageSize ) { //bytes beyond the image belong to settings this firmware does not have
+      memcpy( image + offset, record + RECORD_HEADER_SIZE, (uint32_t)offset + length <= imageSize ? length : imageSize - offset );
+    }
+    stats.recordsLoaded++;
+    position += RECORD_HEADER_SIZE + length + RECORD_CRC_SIZE;
+    if( record[0] == RECORD_MARKER_GROUP_END ) {
+      result.isSnapshotComplete = true;
+      result.groupEndPosition = position;
+    }
+  }
+  if( result.groupEndPosition != position ) { //the last group was not finished
+    result.isTailValid = false;
+  }
+  stats.fileSize = file.size();
+  file.close();
+  return result;
+}
+
+bool TCSettingsJournal::begin( uint8_t* image, uint16_t imageSize ) {
+  unsigned long startedMicros = micros();
+  this->image = image;
+  this->imageSize = imageSize;
+  delete[] dirtyBits;
+  dirtyBits = new uint8_t[( imageSize + 7 ) / 8]();
+  isDirty = false;
+  stats = {};
+
+  uint32_t generations[2] = { 0, 0 };
+  bool isHeaderValid[2] = { readGeneration( 0, generations[0] ), readGeneration( 1, generations[1] ) };
+  uint8_t newestFileIndex = isHeaderValid[1] && ( !isHeaderValid[0] || generations[1] > generations[0] ) ? 1 : 0;
+  for( uint8_t attempt = 0; attempt < 2; attempt++ ) {
+    uint8_t fileIndex = attempt == 0 ? newestFileIndex : 1 - newestFileIndex;
+    if( !isHeaderValid[fileIndex] ) continue;
+    LoadResult result = load( fileIndex, UINT32_MAX );
+    if( !result.isSnapshotComplete ) continue;
+    if( !result.isTailValid ) { //drops the records of an unfinished commit, which are already applied
+      load( fileIndex, result.groupEndPosition );
+    }
+
+    currentFileIndex = fileIndex;
+    stats.compactions = generations[fileIndex];
+    stats.isFallbackUsed = attempt > 0;
+    if( !result.isTailValid || stats.isFallbackUsed ) { //records appended after a broken one would never be read back
+      compact();
+    }
+    stats.loadMicros = micros() - startedMicros;
+    return true;
+  }
+
+  memset( image, 0xFF, imageSize );
+  stats.recordsLoaded = 0;
+  stats.fileSize = 0;
+  stats.loadMicros = micros() - startedMicros;
+  return false;
+}
+
+uint8_t TCSettingsJournal::read( uint16_t offset ) const {
+  if( offset >= imageSize ) return 0xFF;
+  return image[offset];
+}
+
+void TCSettingsJournal::write( uint16_t offset, uint8_t value ) {
+  if( offset >= imageSize || image[offset] == value ) return;
+  image[offset] = value;
+  dirtyBits[offset / 8] |= 1 << ( offset % 8 );
+  isDirty = true;
+}
+
+bool TCSettingsJournal::isDirtyByte( uint16_t offset ) const {
+  return ( dirtyBits[offset / 8] & ( 1 << ( offset % 8 ) ) ) != 0;
+}
+
+bool TCSettingsJournal::writeRecord( File& file, uint16_t offset, uint8_t length, bool isGroupEnd ) {
+  uint8_t recordHeader[RECORD_HEADER_SIZE] = { isGroupEnd ? RECORD_MARKER_GROUP_END : RECORD_MARKER, (uint8_t)( offset & 0xFF ), (uint8_t)( offset >> 8 ), length };
+  uint8_t recordCrc[RECORD_CRC_SIZE];
+  writeUint32( recordCrc, updateCrc32( updateCrc32( 0, recordHeader, RECORD_HEADER_SIZE ), image + offset, length ) );
+  bool isWritten = file.write( recordHeader, RECORD_HEADER_SIZE ) == RECORD_HEADER_SIZE
+      && file.write( image + offset, length ) == length
+      && file.write( recordCrc, RECORD_CRC_SIZE ) == RECORD_CRC_SIZE;
+  stats.bytesWritten += RECORD_HEADER_SIZE + length + RECORD_CRC_SIZE;
+  return isWritten;
+}
+
+bool TCSettingsJournal::commit() {
+  if( !isDirty ) return true;
+  if( stats.compactions == 0 ) return compact(); //no journal file yet
+
+  File file = LittleFS.open( paths[currentFileIndex], "a" );
+  if( !file ) return false;
+  bool isWritten = true;
+  uint16_t pendingOffset = 0; //each run is written once the next one is found, so the last one can end the group
+  uint16_t pendingLength = 0;
+  uint16_t offset = 0;
+  while( offset < imageSize && isWritten ) {
+    if( !isDirtyByte( offset ) ) {
+      offset++;
+      continue;
+    }
+    uint16_t length = 1; //one record per run of changed bytes
+    while( length < RECORD_DATA_MAX && offset + length < imageSize && isDirtyByte( offset + length ) ) {
+      length++;
+    }
+    if( pendingLength > 0 ) {
+      isWritten = writeRecord( file, pendingOffset, pendingLength, false );
+      stats.recordsAppended++;
+    }
+    pendingOffset = offset;
+    pendingLength = length;
+    offset += length;
+  }
+  if( isWritten && pendingLength > 0 ) {
+    isWritten = writeRecord( file, pendingOffset, pendingLength, true );
+    stats.recordsAppended++;
+  }
+  stats.fileSize = file.size();
+  file.close();
+  if( !isWritten ) return compact(); //a partly written record would hide the records appended after it
+
+  memset( dirtyBits, 0, ( imageSize + 7 ) / 8 );
+  isDirty = false;
+  if( stats.fileSize >= compactionSize ) {
+    return compact();
+  }
+  return true;
+}
+
+bool TCSettingsJournal::compact() {
+  uint8_t fileIndex = stats.compactions == 0 ? currentFileIndex : 1 - currentFileIndex;
+  File file = LittleFS.open( paths[fileIndex], "w" );
+  if( !file ) return false;
+
+  uint32_t generation = stats.compactions + 1;
+  uint8_t header[HEADER_SIZE];
+  writeUint32( header, FILE_MAGIC );
+  writeUint32( header + 4, generation );
+  writeUint32( header + 8, updateCrc32( 0, header, 8 ) );
+  bool isWritten = file.write( header, HEADER_SIZE ) == HEADER_SIZE;
+  stats.bytesWritten += HEADER_SIZE;
+  for( uint16_t offset = 0; offset < imageSize && isWritten; offset += RECORD_DATA_MAX ) {
+    uint16_t length = imageSize - offset;
+    if( length > RECORD_DATA_MAX ) length = RECORD_DATA_MAX;
+    isWritten = writeRecord( file, offset, length, offset + length >= imageSize );
+  }
+  uint32_t fileSize = file.size();
+  file.close();
+  if( !isWritten ) return false; //the current file stays the valid one
+
+  currentFileIndex = fileIndex;
+  stats.compactions = generation;
+  stats.fileSize = fileSize;
+  memset( dirtyBits, 0, ( imageSize + 7 ) / 8 );
+  isDirty = false;
+  return true;
+}
+
+const TCSettingsJournal::Stats& TCSettingsJournal::getStats() const {
+  return stats;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+class TCSettingsJournal { //settings image persisted as an append-only log of changed byte ranges in LittleFS; the latest record of each byte wins on load
+                          //records are applied in groups, one per commit, so a power loss never leaves half of a commit applied
+                          //the log alternates between two files: compaction writes a snapshot of the image into the older one, so a power loss at any point leaves the other one loadable
+
+  public:
+    struct Stats {
+      uint32_t compactions; //generation of the loaded journal file, incremented by every compaction
+      uint32_t recordsLoaded; //records replayed at boot
+      uint32_t recordsAppended; //records appended since boot
+      uint32_t bytesWritten; //journal bytes written to flash since boot, including compactions; LittleFS does not report erase counts
+      uint32_t fileSize;
+      uint32_t loadMicros;
+      bool isFallbackUsed; //the newest journal file was damaged and the older one was loaded
+    };
+
+    TCSettingsJournal( const char* pathA, const char* pathB, uint32_t compactionSize );
+
+    bool begin( uint8_t* image, uint16_t imageSize ); //loads the newest valid journal file into the image, which is filled with 0xFF first; returns false when there is none
+    uint8_t read( uint16_t offset ) const;
+    void write( uint16_t offset, uint8_t value ); //changes the image, the byte is persisted by the next commit()
+    bool commit(); //appends the changed byte ranges; compacts the journal when it has grown past the compaction size
+    bool compact(); //writes a snapshot of the whole image into the other journal file, which then becomes the current one
+    const Stats& getStats() const;
+
+  private:
+    static const uint32_t FILE_MAGIC = 0x4A535354; //"TSSJ" in little endian
+    static const uint8_t HEADER_SIZE = 12; //magic, generation and CRC32 of these
+    static const uint8_t RECORD_MARKER = 0xA5;
+    static const uint8_t RECORD_MARKER_GROUP_END = 0xA6; //last record of a commit or of a snapshot
+    static const uint8_t RECORD_HEADER_SIZE = 4; //marker, offset and length
+    static const uint8_t RECORD_CRC_SIZE = 4; //CRC32 of the record header and data
+    static const uint8_t RECORD_DATA_MAX = 255;
+
+    struct LoadResult {
+      bool isSnapshotComplete; //the first group is the snapshot written by the compaction, the file is not valid without it
+      bool isTailValid; //the file ends right after a complete group
+      uint32_t groupEndPosition; //file position after the last complete group
+    };
+
+    const char* paths[2];
+    uint8_t currentFileIndex = 0; //file the records are appended to
+    uint32_t compactionSize;
+    uint8_t* image = NULL;
+    uint16_t imageSize = 0;
+    uint8_t* dirtyBits = NULL; //one bit per image byte changed since the last commit
+    bool isDirty = false;
+    Stats stats = {};
+
+    static uint32_t updateCrc32( uint32_t crc, const uint8_t* data, uint16_t length );
+    static uint32_t readUint32( const uint8_t* data );
+    static void writeUint32( uint8_t* data, uint32_t value );
+
+    bool readGeneration( uint8_t fileIndex, uint32_t& generation );
+    LoadResult load( uint8_t fileIndex, uint32_t endPosition ); //applies the records before endPosition to the image
+    bool isDirtyByte( uint16_t offset ) const;
+    bool writeRecord( File& file, uint16_t offset, uint8_t length, bool isGroupEnd );
+
+};
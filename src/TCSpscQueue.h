@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#ifndef ESP8266
+#include <atomic>
+#endif
+
+template<typename T, uint8_t CAPACITY> class TCSpscQueue { //fixed-size ring for one producer and one consumer, each index is written by one side only
+
+  static_assert( CAPACITY >= 2 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "Queue capacity must be a power of two" );
+
+  public:
+    TCSpscQueue() : head( 0 ), tail( 0 ) {}
+
+    bool push( const T& item ) { //producer side; returns false when the queue is full
+      uint8_t currentTail = load( tail );
+      if( (uint8_t)( currentTail - load( head ) ) == CAPACITY ) return false;
+      items[currentTail & ( CAPACITY - 1 )] = item;
+      store( tail, currentTail + 1 );
+      return true;
+    }
+
+    bool pop( T& item ) { //consumer side; returns false when the queue is empty
+      uint8_t currentHead = load( head );
+      if( currentHead == load( tail ) ) return false;
+      item = items[currentHead & ( CAPACITY - 1 )];
+      store( head, currentHead + 1 );
+      return true;
+    }
+
+  private:
+    T items[CAPACITY];
+    #ifdef ESP8266
+    typedef uint8_t Index; //the producer and the consumer both run from loop()
+    #else //ESP32 or ESP32S2
+    typedef std::atomic<uint8_t> Index;
+    #endif
+    Index head; //next item to pop, written by the consumer
+    Index tail; //next free slot, written by the producer
+
+    static uint8_t load( const Index& index ) {
+      #ifdef ESP8266
+      return index;
+      #else //ESP32 or ESP32S2
+      return index.load( std::memory_order_acquire );
+      #endif
+    }
+
+    static void store( Index& index, uint8_t value ) {
+      #ifdef ESP8266
+      index = value;
+      #else //ESP32 or ESP32S2
+      index.store( value, std::memory_order_release );
+      #endif
+    }
+
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#ifndef ESP8266
+#include <atomic>
+#endif
+
+template<typename T> class TCTripleBuffer { //hands immutable snapshots from one writer to one reader; neither side ever waits for the other
+
+  public:
+    TCTripleBuffer() : writeIndex( 0 ), publishedState( 1 ), readIndex( 2 ) {}
+
+    void publish( const T& value ) { //writer side: the previously published buffer becomes the next write buffer
+      buffers[writeIndex] = value;
+      writeIndex = exchangePublishedState( writeIndex | STATE_FRESH ) & STATE_INDEX_MASK;
+    }
+
+    const T& read() { //reader side: picks up the latest snapshot, if any; the returned value stays unchanged until the next read()
+      if( loadPublishedState() & STATE_FRESH ) {
+        readIndex = exchangePublishedState( readIndex ) & STATE_INDEX_MASK;
+      }
+      return buffers[readIndex];
+    }
+
+  private:
+    static const uint8_t STATE_INDEX_MASK = 0x03;
+    static const uint8_t STATE_FRESH = 0x04; //set when the published buffer has not been picked up by the reader yet
+
+    T buffers[3];
+    uint8_t writeIndex; //owned by the writer
+    #ifdef ESP8266
+    uint8_t publishedState; //the writer and the reader both run from loop()
+    #else //ESP32 or ESP32S2
+    std::atomic<uint8_t> publishedState;
+    #endif
+    uint8_t readIndex; //owned by the reader
+
+    uint8_t loadPublishedState() {
+      #ifdef ESP8266
+      return publishedState;
+      #else //ESP32 or ESP32S2
+      return publishedState.load();
+      #endif
+    }
+
+    uint8_t exchangePublishedState( uint8_t state ) {
+      #ifdef ESP8266
+      uint8_t previousState = publishedState;
+      publishedState = state;
+      return previousState;
+      #else //ESP32 or ESP32S2
+      return publishedState.exchange( state );
+      #endif
+    }
+
+};
@@ -1,7 +1,5 @@
 #include <Arduino.h>
 
-#include <vector>
-
 #ifdef ESP8266
 #include <ESP8266WiFi.h>
 #include <ESP8266WebServer.h>
@@ -20,6 +18,8 @@
 #include <WiFiUdp.h>
 #else //ESP32 or ESP32S2
 #include <esp_sntp.h>
+#include <atomic>
+#include <TCSpscQueue.h> //display command queue of the render task
 #endif
 
 #include <EEPROM.h>
@@ -29,6 +29,12 @@
 
 #include <TCData.h>
 #include <TCFonts.h>
+#include <TCLayout.h>
+#include <TCGlyphCache.h>
+#include <TCAnimations.h>
+#include <TCScheduler.h>
+#include <TCTripleBuffer.h>
+#include <TCSettingsJournal.h>
 
 #define MAX_HARDWARE_TYPE MD_MAX72XX::FC16_HW
 #define MAX_MAX_DEVICES 4
@@ -54,8 +60,10 @@ bool isEnergySavingMode = false;
 
 #ifdef ESP8266
 #define BRIGHTNESS_INPUT_PIN A0
-#else //ESP32 or ESP32S2
+#elif defined(ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S2) || defined(ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32S3)
 #define BRIGHTNESS_INPUT_PIN 3
+#else
+#define BRIGHTNESS_INPUT_PIN 36 //GPIO3 is UART RX on ESP32, ADC1 channel 0 is used instead
 #endif
 
 #ifdef ESP8266
@@ -79,7 +87,7 @@ bool isEnergySavingMode = false;
 #define ADC_NUMBER_OF_VALUES ( 1 << ADC_RESOLUTION )
 #define ADC_STEP_FOR_BYTE ( ADC_NUMBER_OF_VALUES / ( 1 << ( 8 * sizeof( uint8_t ) ) ) )
 
-uint8_t EEPROM_FLASH_DATA_VERSION = 00 + 3; //change to next number when eeprom data format is changed. 255 is a reserved value: is set to 255 when: hard reset pin is at 3.3V (high); during factory reset procedure; when FW is loaded to a new device (EEPROM reads FF => 255)
+uint8_t EEPROM_FLASH_DATA_VERSION = 00 + 4; //change to next number when eeprom data format is changed, and add a migration from the previous number to EEPROM_DATA_MIGRATIONS. 255 is a reserved value: is set to 255 when: hard reset pin is at 3.3V (high); during factory reset procedure; when FW is loaded to a new device (EEPROM reads FF => 255)
 uint8_t eepromFlashDataVersion = EEPROM_FLASH_DATA_VERSION;
 const char* getFirmwareVersion() { const char* result =
 #include "fw_version.txt"
@@ -88,9 +96,6 @@ const char* getFirmwareVersion() { const char* result =
 //device name
 char deviceName[16 + 1];
 
-//wifi configuration
-bool isWiFiRadioShutDown = false;
-
 //wifi access point configuration
 const char* getWiFiAccessPointSsid() { const char* result = "Clock"; return result; };
 const char* getWiFiAccessPointPassword() { const char* result = "1029384756"; return result; };
@@ -100,8 +105,9 @@ const uint32_t TIMEOUT_AP = 120000;
 
 //wifi client configuration
 const char* getWiFiHostName() { const char* result = "Clock"; return result; }
-const uint32_t TIMEOUT_CONNECT_WIFI_SYNC = 90000;
+const uint32_t TIMEOUT_CONNECT_WIFI = 30000; //time given to each known network; falls back to the access point when none of them is connected
 const uint32_t DELAY_WIFI_CONNECTION_CHECK = 60000;
+const uint16_t DELAY_WIFI_CONNECTING_CHECK = 500;
 
 //internal on-board status led config
 #ifdef ESP8266
@@ -118,33 +124,52 @@ const uint16_t DELAY_INTERNAL_LED_ANIMATION_HIGH = 200;
 const uint32_t DELAY_NTP_TIME_SYNC = 6 * 60 * 60 * 1000; //sync time every 6 hours
 const uint32_t DELAY_NTP_TIME_SYNC_RETRY = 2 * 60 * 60 * 1000; //sync time every 2 hours if regular sync fails
 const uint32_t DELAY_NTP_TIME_SYNC_AGGRESSIVE = 10 * 1000; //sync time every 10 seconds if regular sync fails
-bool isSlowSemicolonAnimation = false; //semicolon period, false = 60 blinks per minute; true = 30 blinks per minute
-const uint16_t DELAY_DISPLAY_ANIMATION = 20; //led animation speed, in ms
+const uint32_t DELAY_NTP_STATUS_CHECK = DELAY_NTP_TIME_SYNC + DELAY_NTP_TIME_SYNC_RETRY + DELAY_NTP_TIME_SYNC_AGGRESSIVE * 6; //ESP32 SNTP falls back to the retry interval when there was no sync for this long
+const uint16_t DELAY_DISPLAY_RENDER_MAX = 1000; //longest time between display renders, in ms; renders are normally scheduled at the next visible change
+const uint32_t DELAY_RENDER_STATS_WINDOW = 60000; //render counts and idle loops are reported per this window, in ms
+const uint8_t DISPLAY_RENDER_WAKEUPS_PER_SECOND_POLLING = 1000 / 20; //render wakeups per second when the display was polled every 20 ms, reported next to the measured rate
+const uint16_t DELAY_LOOP_IDLE_MAX = 2; //longest idle delay at the end of loop(), so the web server stays responsive; shorter when a scheduler task is due sooner
+const uint16_t DELAY_LOOP_LIGHT_SLEEP_MAX = 50; //longest light sleep at the end of loop() in energy saving mode
 
 //variables used in the code, don't change anything here
-char wiFiClientSsid[32 + 1];
-char wiFiClientPassword[32 + 1];
-
-uint8_t displayFontTypeNumber = 1;
-bool isDisplayBoldFontUsed = false;
-bool isDisplayCompactLayoutUsed = false;
-bool isDisplaySecondsShown = false;
-uint8_t displayDayBrightness = 9;
-uint8_t displayNightBrightness = 0;
-bool isForceDisplaySync = true;
-bool isForceDisplaySyncDisplayRenderOverride = false;
-bool isSingleDigitHourShown = true;
-bool isRotateDisplay = false;
-bool isClockAnimated = false;
-uint8_t animationTypeNumber = 1;
-uint8_t brightnessSteepnessCoefficient = 72;
-float brightnessSteepnessCoefficientStep = 0.05;
+const uint8_t WIFI_CREDENTIALS_COUNT = 4; //known networks, e.g. of the places the clock is moved between
+struct WiFiCredential {
+  char ssid[32 + 1];
+  char password[32 + 1];
+  uint8_t successRank; //0 for the most recently connected network, unique per credential
+};
+WiFiCredential wiFiCredentials[WIFI_CREDENTIALS_COUNT];
+
+struct ClockSettings { //display and brightness settings; loop() changes the working copy, the renderer only reads published snapshots of it
+  uint32_t version = 0; //incremented on every publish
+  uint8_t displayFontTypeNumber; //defaults, ranges and storage of the settings are in CLOCK_SETTINGS
+  bool isDisplayBoldFontUsed;
+  bool isDisplayCompactLayoutUsed;
+  bool isDisplaySecondsShown;
+  uint8_t displayDayBrightness;
+  uint8_t displayNightBrightness;
+  bool isSingleDigitHourShown;
+  bool isRotateDisplay;
+  bool isClockAnimated;
+  uint8_t animationTypeNumber;
+  bool isSlowSemicolonAnimation; //semicolon period, false = 60 blinks per minute; true = 30 blinks per minute
+  uint8_t brightnessSteepnessCoefficient;
+  uint16_t sensorBrightnessNightLevel; //brightness settings
+  uint16_t sensorBrightnessDayLevel;
+};
+
+ClockSettings clockSettings; //working copy
+TCTripleBuffer<ClockSettings> publishedClockSettings; //written by publishClockSettings(), read by the renderer once per frame
+
+void publishClockSettings() { //call once all the changes of a request are applied to the working copy, so the renderer never sees them half-applied
+  clockSettings.version++;
+  publishedClockSettings.publish( clockSettings );
+}
 
-//brightness settings
-uint16_t sensorBrightnessNightLevel = 0;
-uint16_t sensorBrightnessDayLevel = ADC_NUMBER_OF_VALUES - 1;
+float brightnessSteepnessCoefficientStep = 0.05;
 
 const uint16_t DELAY_SENSOR_BRIGHTNESS_UPDATE_CHECK = 100;
+const uint16_t DELAY_NTP_CLIENT_UPDATE_CHECK = 10;
 const double SENSOR_BRIGHTNESS_LEVEL_HYSTERESIS = 0.10;
 const uint16_t SENSOR_BRIGHTNESS_SUSTAINED_LEVEL_HYSTERESIS_OVERRIDE_MILLIS = 10000;
 
@@ -177,22 +202,25 @@ MD_MAX72XX display = MD_MAX72XX( MAX_HARDWARE_TYPE, MAX_CS_PIN, MAX_MAX_DEVICES
 
 //init methods
 bool isFirstLoopRun = true;
-unsigned long previousMillisDisplayAnimation = millis();
-unsigned long previousMillisSemicolonAnimation = millis();
-unsigned long previousMillisInternalLed = millis();
-unsigned long previousMillisWiFiStatusCheck = millis();
-unsigned long previousMillisNtpStatusCheck = millis();
-unsigned long previousMillisSensorBrightnessCheck = millis();
+
+TCScheduler scheduler; //runs timed subsystem ticks from loop(), tasks are registered in initScheduler()
+uint8_t internalLedTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t displayRenderTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t brightnessTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t wiFiTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t ntpTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t ntpStatusCheckTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t renderStatsTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t displayTestTaskId = TCScheduler::INVALID_TASK_ID;
+uint8_t wiFiScanTaskId = TCScheduler::INVALID_TASK_ID;
 
 void initVariables() {
   isFirstLoopRun = true;
-  unsigned long currentMillis = millis();
-  previousMillisDisplayAnimation = currentMillis;
-  previousMillisSemicolonAnimation = currentMillis;
-  previousMillisInternalLed = currentMillis;
-  previousMillisWiFiStatusCheck = currentMillis;
-  previousMillisNtpStatusCheck = currentMillis;
-  previousMillisSensorBrightnessCheck = currentMillis;
+  scheduler.rescheduleTask( internalLedTaskId, 0 );
+  scheduler.rescheduleTask( displayRenderTaskId, 0 );
+  scheduler.rescheduleTask( brightnessTaskId, DELAY_SENSOR_BRIGHTNESS_UPDATE_CHECK );
+  scheduler.rescheduleTask( ntpTaskId, DELAY_NTP_CLIENT_UPDATE_CHECK );
+  scheduler.rescheduleTask( ntpStatusCheckTaskId, DELAY_NTP_STATUS_CHECK );
 }
 
 
@@ -257,7 +285,15 @@ void writeToSerial( String data, bool isNextLine ) {
   }
 }
 
+const char SETTINGS_JOURNAL_PATH_A[] = "/settings.a"; //the settings journal files, never served by getFileFromFlash()
+const char SETTINGS_JOURNAL_PATH_B[] = "/settings.b";
+
 File getFileFromFlash( String fileName ) {
+  while( fileName.startsWith( "/" ) ) {
+    fileName.remove( 0, 1 );
+  }
+  String filePath = "/" + fileName;
+  if( filePath == SETTINGS_JOURNAL_PATH_A || filePath == SETTINGS_JOURNAL_PATH_B ) return File(); //settings journal files hold the WiFi passwords
   bool isGzippedFileRequested = fileName.endsWith( F(".gz") );
 
   File root = LittleFS.open("/", "r");
@@ -272,13 +308,30 @@ File getFileFromFlash( String fileName ) {
     file2 = root.openNextFile();
   }
 
-  File file = LittleFS.open( "/" + fileName + ( isGzippedFileRequested ? "" : String( F(".gz") ) ), "r" );
+  File file = LittleFS.open( filePath + ( isGzippedFileRequested ? "" : String( F(".gz") ) ), "r" );
   if( !isGzippedFileRequested && !file ) {
-    file = LittleFS.open( "/" + fileName, "r" );
+    file = LittleFS.open( filePath, "r" );
   }
   return file;
 }
 
+void loadCustomAnimations() { //custom animation descriptors are read from /animationN.bin, N in the range right after the built-in ones; the whole range is scanned, so a missing or invalid file does not hide the next ones
+  for( uint8_t fileNumber = TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS + 1; fileNumber <= TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS + TCAnimations::MAX_CUSTOM_ANIMATIONS; ++fileNumber ) {
+    String fileName = String( F("/animation") ) + String( fileNumber ) + String( F(".bin") );
+    if( !LittleFS.exists( fileName ) ) continue;
+    File file = LittleFS.open( fileName, "r" );
+    if( !file ) continue;
+    uint8_t data[TCAnimations::MAX_DATA_SIZE];
+    size_t dataSize = file.size() <= sizeof(data) ? file.read( data, file.size() ) : 0;
+    file.close();
+    if( !TCAnimations::addCustomAnimation( data, dataSize ) ) {
+      writeToSerial( String( F("Invalid animation file ") ) + fileName, true );
+      continue;
+    }
+    writeToSerial( String( F("Loaded animation ") ) + fileName + String( F(" as animation ") ) + String( TCAnimations::getAnimationCount() ), true ); //animations are numbered in load order, so the number differs from N after a gap
+  }
+}
+
 void sanitizeTextAscii( const String &input, char* outDeviceName, size_t maxBytes ) {
     String v = input;
     while(v.length() && (v[0] == ' ' || v[0] == '-')) v.remove(0,1); //Remove leading spaces/hyphens
@@ -301,9 +354,9 @@ void sanitizeTextAscii( const String &input, char* outDeviceName, size_t maxByte
 
 //eeprom functionality
 const uint16_t eepromFlashDataVersionIndex = 0;
-const uint16_t eepromWiFiSsidIndex = eepromFlashDataVersionIndex + 1;
-const uint16_t eepromWiFiPasswordIndex = eepromWiFiSsidIndex + sizeof(wiFiClientSsid);
-const uint16_t eepromDeviceNameIndex = eepromWiFiPasswordIndex + sizeof(wiFiClientPassword);
+const uint16_t eepromWiFiCredentialsIndex = eepromFlashDataVersionIndex + 1;
+const uint16_t EEPROM_WIFI_CREDENTIAL_SIZE = sizeof(WiFiCredential::ssid) + sizeof(WiFiCredential::password) + 1;
+const uint16_t eepromDeviceNameIndex = eepromWiFiCredentialsIndex + WIFI_CREDENTIALS_COUNT * EEPROM_WIFI_CREDENTIAL_SIZE;
 const uint16_t eepromDisplayFontTypeNumberIndex = eepromDeviceNameIndex + sizeof(deviceName);
 const uint16_t eepromIsFontBoldUsedIndex = eepromDisplayFontTypeNumberIndex + 1;
 const uint16_t eepromIsDisplaySecondsShownIndex = eepromIsFontBoldUsedIndex + 1;
@@ -322,15 +375,76 @@ const uint16_t eepromCustomFontIndex = eepromIsCompactLayoutShownIndex + 1;
 const uint16_t eepromLastByteIndex = eepromCustomFontIndex + TCFonts::FONT_SYMBOLS * TCFonts::FONT_HEIGHT;
 
 const uint16_t EEPROM_ALLOCATED_SIZE = eepromLastByteIndex;
-void initEeprom() {
-  EEPROM.begin( EEPROM_ALLOCATED_SIZE ); //init this many bytes
+
+uint16_t getEepromWiFiSsidIndex( uint8_t credentialIndex ) {
+  return eepromWiFiCredentialsIndex + credentialIndex * EEPROM_WIFI_CREDENTIAL_SIZE;
+}
+
+uint16_t getEepromWiFiPasswordIndex( uint8_t credentialIndex ) {
+  return getEepromWiFiSsidIndex( credentialIndex ) + sizeof(WiFiCredential::ssid);
+}
+
+uint16_t getEepromWiFiSuccessRankIndex( uint8_t credentialIndex ) {
+  return getEepromWiFiPasswordIndex( credentialIndex ) + sizeof(WiFiCredential::password);
+}
+
+//the eeprom image is persisted by a journal in LittleFS instead of the EEPROM sector, so a change appends a few bytes rather than rewriting the whole sector
+const uint32_t SETTINGS_JOURNAL_COMPACTION_SIZE = 8192; //about four snapshots of the image
+uint8_t settingsImage[EEPROM_ALLOCATED_SIZE];
+TCSettingsJournal settingsJournal( SETTINGS_JOURNAL_PATH_A, SETTINGS_JOURNAL_PATH_B, SETTINGS_JOURNAL_COMPACTION_SIZE );
+
+const uint8_t EEPROM_IMPORTED_MARKER = 254; //written over the data version in the EEPROM sector once it is imported into the journal
+
+void initEeprom() { //needs LittleFS mounted
+  if( settingsJournal.begin( settingsImage, EEPROM_ALLOCATED_SIZE ) ) return;
+
+  EEPROM.begin( EEPROM_ALLOCATED_SIZE );
+  if( EEPROM.read( eepromFlashDataVersionIndex ) == EEPROM_IMPORTED_MARKER ) { //the journal was lost, e.g. by a filesystem upload; the sector is outdated since the import, so defaults are loaded
+    writeToSerial( F("Settings journal is missing"), true );
+    EEPROM.end();
+    return;
+  }
+
+  writeToSerial( F("Importing settings from EEPROM"), true ); //first boot after the firmware update
+  for( uint16_t i = 0; i < EEPROM_ALLOCATED_SIZE; i++ ) {
+    settingsImage[i] = EEPROM.read( i );
+  }
+  if( settingsJournal.compact() ) {
+    EEPROM.write( eepromFlashDataVersionIndex, EEPROM_IMPORTED_MARKER );
+    EEPROM.commit();
+  }
+  EEPROM.end();
+}
+
+//writes between beginEepromTransaction() and commitEepromTransaction() are flushed with a single commit, so one settings save appends one batch of journal records
+uint8_t eepromTransactionDepth = 0;
+bool isEepromTransactionDirty = false;
+
+void beginEepromTransaction() {
+  eepromTransactionDepth++;
+}
+
+bool commitEepromTransaction() { //returns true when the outermost transaction has written to flash
+  if( eepromTransactionDepth == 0 ) return false;
+  eepromTransactionDepth--;
+  if( eepromTransactionDepth > 0 || !isEepromTransactionDirty ) return false;
+  isEepromTransactionDirty = false;
+  return settingsJournal.commit();
+}
+
+void commitEepromChanges() { //called by the write functions after changing bytes
+  if( eepromTransactionDepth > 0 ) {
+    isEepromTransactionDirty = true;
+    return;
+  }
+  settingsJournal.commit();
 }
 
 bool readEepromCharArray( const uint16_t& eepromIndex, char* variableWithValue, uint8_t maxLength, bool doApplyValue ) {
   bool isDifferentValue = false;
   uint16_t eepromStartIndex = eepromIndex;
   for( uint16_t i = eepromStartIndex; i < eepromStartIndex + maxLength; i++ ) {
-    char eepromChar = EEPROM.read(i);
+    char eepromChar = settingsJournal.read(i);
     if( doApplyValue ) {
       variableWithValue[i-eepromStartIndex] = eepromChar;
     } else {
@@ -345,14 +459,14 @@ bool writeEepromCharArray( const uint16_t& eepromIndex, char* newValue, uint8_t
   if( !isDifferentValue ) return false;
   uint16_t eepromStartIndex = eepromIndex;
   for( uint16_t i = eepromStartIndex; i < eepromStartIndex + maxLength; i++ ) {
-    EEPROM.write( i, newValue[i-eepromStartIndex] );
+    settingsJournal.write( i, newValue[i-eepromStartIndex] );
   }
-  EEPROM.commit();
+  commitEepromChanges();
   return true;
 }
 
 uint8_t readEepromUint8Value( const uint16_t& eepromIndex, uint8_t& variableWithValue, bool doApplyValue ) {
-  uint8_t eepromValue = EEPROM.read( eepromIndex );
+  uint8_t eepromValue = settingsJournal.read( eepromIndex );
   if( doApplyValue ) {
     variableWithValue = eepromValue;
   }
@@ -362,18 +476,18 @@ uint8_t readEepromUint8Value( const uint16_t& eepromIndex, uint8_t& variableWith
 bool writeEepromUint8Value( const uint16_t& eepromIndex, uint8_t newValue ) {
   bool eepromWritten = false;
   if( readEepromUint8Value( eepromIndex, newValue, false ) != newValue ) {
-    EEPROM.write( eepromIndex, newValue );
+    settingsJournal.write( eepromIndex, newValue );
     eepromWritten = true;
   }
   if( eepromWritten ) {
-    EEPROM.commit();
+    commitEepromChanges();
   }
   return eepromWritten;
 }
 
 uint16_t readEepromUint16Value( const uint16_t& eepromIndex, uint16_t& variableWithValue, bool doApplyValue ) {
-    uint8_t lo = EEPROM.read( eepromIndex );
-    uint8_t hi = EEPROM.read( eepromIndex + 1 );
+    uint8_t lo = settingsJournal.read( eepromIndex );
+    uint8_t hi = settingsJournal.read( eepromIndex + 1 );
     uint16_t eepromValue = (uint16_t)lo | ((uint16_t)hi << 8);
     if( doApplyValue ) {
         variableWithValue = eepromValue;
@@ -384,18 +498,18 @@ uint16_t readEepromUint16Value( const uint16_t& eepromIndex, uint16_t& variableW
 bool writeEepromUint16Value( const uint16_t& eepromIndex, uint16_t newValue ) {
     bool eepromWritten = false;
     if( readEepromUint16Value( eepromIndex, newValue, false ) != newValue ) {
-        EEPROM.write( eepromIndex, newValue & 0xFF );
-        EEPROM.write( eepromIndex + 1, newValue >> 8 );
+        settingsJournal.write( eepromIndex, newValue & 0xFF );
+        settingsJournal.write( eepromIndex + 1, newValue >> 8 );
         eepromWritten = true;
     }
     if( eepromWritten ) {
-        EEPROM.commit();
+        commitEepromChanges();
     }
     return eepromWritten;
 }
 
 bool readEepromBoolValue( const uint16_t& eepromIndex, bool& variableWithValue, bool doApplyValue ) {
-  uint8_t eepromValue = EEPROM.read( eepromIndex ) != 0 ? 1 : 0;
+  uint8_t eepromValue = settingsJournal.read( eepromIndex ) != 0 ? 1 : 0;
   if( doApplyValue ) {
     variableWithValue = eepromValue;
   }
@@ -405,11 +519,11 @@ bool readEepromBoolValue( const uint16_t& eepromIndex, bool& variableWithValue,
 bool writeEepromBoolValue( const uint16_t& eepromIndex, bool newValue ) {
   bool eepromWritten = false;
   if( readEepromBoolValue( eepromIndex, newValue, false ) != newValue ) {
-    EEPROM.write( eepromIndex, newValue ? 1 : 0 );
+    settingsJournal.write( eepromIndex, newValue ? 1 : 0 );
     eepromWritten = true;
   }
   if( eepromWritten ) {
-    EEPROM.commit();
+    commitEepromChanges();
   }
   return eepromWritten;
 }
@@ -419,7 +533,7 @@ void readEepromFontData() {
   for( uint16_t symbolIndex = 0; symbolIndex < TCFonts::FONT_SYMBOLS; symbolIndex++ ) {
     for( uint8_t byteIndex = 0; byteIndex < TCFonts::FONT_HEIGHT; byteIndex++ ) {
       uint16_t eepromIndex = eepromCustomFontIndex + ( symbolIndex * TCFonts::FONT_HEIGHT ) + byteIndex;
-      fontToUse[symbolIndex][byteIndex] = EEPROM.read( eepromIndex );
+      fontToUse[symbolIndex][byteIndex] = settingsJournal.read( eepromIndex );
     }
   }
 }
@@ -430,29 +544,218 @@ bool writeEepromFontData( bool doErase ) {
   for( uint16_t symbolIndex = 0; symbolIndex < TCFonts::FONT_SYMBOLS; symbolIndex++ ) {
     for( uint8_t byteIndex = 0; byteIndex < TCFonts::FONT_HEIGHT; byteIndex++ ) {
       uint16_t eepromIndex = eepromCustomFontIndex + ( symbolIndex * TCFonts::FONT_HEIGHT ) + byteIndex;
-      uint8_t byteStored = EEPROM.read( eepromIndex );
+      uint8_t byteStored = settingsJournal.read( eepromIndex );
       uint8_t byteToStore = doErase ? 0 : fontToUse[symbolIndex][byteIndex];
       if( byteStored != byteToStore ) {
         eepromWritten = true;
-        EEPROM.write( eepromIndex, byteToStore );
+        settingsJournal.write( eepromIndex, byteToStore );
       }
     }
   }
   if( eepromWritten ) {
-    EEPROM.commit();
+    commitEepromChanges();
   }
   return eepromWritten;
 }
 
+//settings form field names, also used as keys of the settings in /monitor
+const char HTML_PAGE_WIFI_SSID_NAME[] = "ssid"; //followed by the credential index
+const char HTML_PAGE_WIFI_PWD_NAME[] = "pwd";
+
+const char HTML_PAGE_FONT_TYPE_NAME[] = "fnt";
+const char HTML_PAGE_BOLD_FONT_NAME[] = "bld";
+const char HTML_PAGE_SHOW_SECS_NAME[] = "sec";
+const char HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME[] = "sdh";
+const char HTML_PAGE_COMPACT_LAYOUT_NAME[] = "cl";
+const char HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME[] = "ssa";
+const char HTML_PAGE_ROTATE_DISPLAY_NAME[] = "rot";
+const char HTML_PAGE_CLOCK_ANIMATED_NAME[] = "ca";
+const char HTML_PAGE_ANIMATION_TYPE_NAME[] = "at";
+const char HTML_PAGE_BRIGHTNESS_DAY_NAME[] = "brtd";
+const char HTML_PAGE_BRIGHTNESS_NIGHT_NAME[] = "brtn";
+const char HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME[] = "brsd";
+const char HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME[] = "brsn";
+const char HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME[] = "brst";
+const char HTML_PAGE_DEVICE_NAME_NAME[] = "dvn";
+
+//clock settings registry: one entry per ClockSettings field drives loading, defaults, validation, form parsing and the JSON dump
+enum ClockSettingType : uint8_t {
+  CLOCK_SETTING_BOOL,
+  CLOCK_SETTING_UINT8,
+  CLOCK_SETTING_UINT16
+};
+
+enum ClockSettingOutOfRange : uint8_t { //how a stored value out of range is loaded, as the v3 firmware did for each field
+  CLOCK_SETTING_OUT_OF_RANGE_DEFAULT,
+  CLOCK_SETTING_OUT_OF_RANGE_CLAMP //to the nearest end of the range
+};
+
+const uint8_t CLOCK_SETTING_EFFECT_RERENDER = 1;
+const uint8_t CLOCK_SETTING_EFFECT_INTENSITY = 2; //display brightness is recalculated
+const uint8_t CLOCK_SETTING_EFFECT_SYNC = 4; //semicolon blinking is restarted
+
+struct ClockSettingDescriptor {
+  const char* name; //form field name
+  ClockSettingType type;
+  uint16_t fieldOffset; //in ClockSettings
+  uint16_t eepromIndex;
+  uint16_t minValue;
+  uint16_t maxValue;
+  uint8_t (*getMaxValue)(); //overrides maxValue when the range is only known at runtime
+  uint16_t defaultValue;
+  ClockSettingOutOfRange outOfRange;
+  uint8_t effects; //applied after a change from the settings page
+};
+
+constexpr ClockSettingDescriptor CLOCK_SETTINGS[] = {
+  { HTML_PAGE_FONT_TYPE_NAME, CLOCK_SETTING_UINT8, offsetof(ClockSettings, displayFontTypeNumber), eepromDisplayFontTypeNumberIndex, 1, TCFonts::NUMBER_OF_FONTS_SUPPORTED, NULL, 1, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_BOLD_FONT_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isDisplayBoldFontUsed), eepromIsFontBoldUsedIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_SHOW_SECS_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isDisplaySecondsShown), eepromIsDisplaySecondsShownIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_BRIGHTNESS_DAY_NAME, CLOCK_SETTING_UINT8, offsetof(ClockSettings, displayDayBrightness), eepromDisplayDayBrightnessIndex, 0, 15, NULL, 9, CLOCK_SETTING_OUT_OF_RANGE_CLAMP, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_INTENSITY },
+  { HTML_PAGE_BRIGHTNESS_NIGHT_NAME, CLOCK_SETTING_UINT8, offsetof(ClockSettings, displayNightBrightness), eepromDisplayNightBrightnessIndex, 0, 15, NULL, 0, CLOCK_SETTING_OUT_OF_RANGE_CLAMP, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_INTENSITY },
+  { HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME, CLOCK_SETTING_UINT16, offsetof(ClockSettings, sensorBrightnessDayLevel), eepromSensorBrightnessDayLevelIndex, 0, ADC_NUMBER_OF_VALUES - 1, NULL, ADC_NUMBER_OF_VALUES - 1, CLOCK_SETTING_OUT_OF_RANGE_CLAMP, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_INTENSITY },
+  { HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME, CLOCK_SETTING_UINT16, offsetof(ClockSettings, sensorBrightnessNightLevel), eepromSensorBrightnessNightLevelIndex, 0, ADC_NUMBER_OF_VALUES - 1, NULL, 0, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_INTENSITY },
+  { HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME, CLOCK_SETTING_UINT8, offsetof(ClockSettings, brightnessSteepnessCoefficient), eepromBrightnessSteepnessCoefficientIndex, 0, 255, NULL, 72, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_INTENSITY },
+  { HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isSingleDigitHourShown), eepromIsSingleDigitHourShownIndex, 0, 1, NULL, true, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_ROTATE_DISPLAY_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isRotateDisplay), eepromIsRotateDisplayIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isSlowSemicolonAnimation), eepromIsSlowSemicolonAnimationIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER | CLOCK_SETTING_EFFECT_SYNC },
+  { HTML_PAGE_CLOCK_ANIMATED_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isClockAnimated), eepromIsClockAnimatedIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_ANIMATION_TYPE_NAME, CLOCK_SETTING_UINT8, offsetof(ClockSettings, animationTypeNumber), eepromAnimationTypeNumberIndex, 1, 1, TCAnimations::getAnimationCount, 1, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER },
+  { HTML_PAGE_COMPACT_LAYOUT_NAME, CLOCK_SETTING_BOOL, offsetof(ClockSettings, isDisplayCompactLayoutUsed), eepromIsCompactLayoutShownIndex, 0, 1, NULL, false, CLOCK_SETTING_OUT_OF_RANGE_DEFAULT, CLOCK_SETTING_EFFECT_RERENDER }
+};
+const uint8_t CLOCK_SETTINGS_COUNT = sizeof(CLOCK_SETTINGS) / sizeof(CLOCK_SETTINGS[0]);
+
+uint16_t getClockSettingValue( const ClockSettings& settings, const ClockSettingDescriptor& setting ) {
+  const uint8_t* field = reinterpret_cast<const uint8_t*>( &settings ) + setting.fieldOffset;
+  switch( setting.type ) {
+    case CLOCK_SETTING_BOOL: return *reinterpret_cast<const bool*>( field ) ? 1 : 0;
+    case CLOCK_SETTING_UINT8: return *field;
+    default: return *reinterpret_cast<const uint16_t*>( field );
+  }
+}
+
+void setClockSettingValue( ClockSettings& settings, const ClockSettingDescriptor& setting, uint16_t value ) {
+  uint8_t* field = reinterpret_cast<uint8_t*>( &settings ) + setting.fieldOffset;
+  switch( setting.type ) {
+    case CLOCK_SETTING_BOOL: *reinterpret_cast<bool*>( field ) = value != 0; break;
+    case CLOCK_SETTING_UINT8: *field = value; break;
+    default: *reinterpret_cast<uint16_t*>( field ) = value; break;
+  }
+}
+
+bool isClockSettingValueValid( const ClockSettingDescriptor& setting, long value ) {
+  uint16_t maxValue = setting.getMaxValue != NULL ? setting.getMaxValue() : setting.maxValue;
+  return value >= setting.minValue && value <= maxValue;
+}
+
+void validateClockSettings( ClockSettings& settings ) { //rules between settings; the range of each one is checked when it is read
+  if( settings.displayNightBrightness > settings.displayDayBrightness ) settings.displayNightBrightness = settings.displayDayBrightness;
+  if( settings.sensorBrightnessNightLevel > settings.sensorBrightnessDayLevel ) settings.sensorBrightnessNightLevel = settings.sensorBrightnessDayLevel;
+}
+
+uint16_t readEepromClockSetting( const ClockSettingDescriptor& setting ) {
+  bool boolValue;
+  uint8_t uint8Value;
+  uint16_t uint16Value;
+  switch( setting.type ) {
+    case CLOCK_SETTING_BOOL: return readEepromBoolValue( setting.eepromIndex, boolValue, false );
+    case CLOCK_SETTING_UINT8: return readEepromUint8Value( setting.eepromIndex, uint8Value, false );
+    default: return readEepromUint16Value( setting.eepromIndex, uint16Value, false );
+  }
+}
+
+uint16_t getClockSettingValueInRange( const ClockSettingDescriptor& setting, uint16_t value ) { //applies the out of range policy of the setting
+  if( isClockSettingValueValid( setting, value ) ) return value;
+  if( setting.outOfRange == CLOCK_SETTING_OUT_OF_RANGE_DEFAULT ) return setting.defaultValue;
+  uint16_t maxValue = setting.getMaxValue != NULL ? setting.getMaxValue() : setting.maxValue;
+  return value < setting.minValue ? setting.minValue : maxValue;
+}
+
+void readEepromClockSettings() { //a value out of range is replaced by the default or clamped, depending on the setting
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    const ClockSettingDescriptor& setting = CLOCK_SETTINGS[i];
+    setClockSettingValue( clockSettings, setting, getClockSettingValueInRange( setting, readEepromClockSetting( setting ) ) );
+  }
+  validateClockSettings( clockSettings );
+}
+
+bool writeEepromClockSetting( const ClockSettingDescriptor& setting, uint16_t value ) {
+  switch( setting.type ) {
+    case CLOCK_SETTING_BOOL: return writeEepromBoolValue( setting.eepromIndex, value != 0 );
+    case CLOCK_SETTING_UINT8: return writeEepromUint8Value( setting.eepromIndex, value );
+    default: return writeEepromUint16Value( setting.eepromIndex, value );
+  }
+}
+
+void writeEepromClockSettingDefaults() {
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    const ClockSettingDescriptor& setting = CLOCK_SETTINGS[i];
+    setClockSettingValue( clockSettings, setting, setting.defaultValue );
+    writeEepromClockSetting( setting, setting.defaultValue );
+  }
+}
+
+//eeprom data migrations: each one upgrades the image of the previous data version in place, so a layout change keeps the settings instead of resetting them to defaults
+void migrateEepromDataV3ToV4() { //v3 stored a single WiFi network, v4 stores WIFI_CREDENTIALS_COUNT of them with a success rank each
+  const uint16_t eepromV3DeviceNameIndex = eepromWiFiCredentialsIndex + sizeof(WiFiCredential::ssid) + sizeof(WiFiCredential::password);
+  for( uint16_t i = EEPROM_ALLOCATED_SIZE - eepromDeviceNameIndex; i > 0; i-- ) { //moves the settings after the network from the end, since both ranges overlap
+    settingsJournal.write( eepromDeviceNameIndex + i - 1, settingsJournal.read( eepromV3DeviceNameIndex + i - 1 ) );
+  }
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) { //the v3 network is already in place as the first one
+    if( i > 0 ) {
+      for( uint16_t j = getEepromWiFiSsidIndex( i ); j < getEepromWiFiSuccessRankIndex( i ); j++ ) {
+        settingsJournal.write( j, 0 );
+      }
+    }
+    settingsJournal.write( getEepromWiFiSuccessRankIndex( i ), i );
+  }
+}
+
+typedef void (*EepromDataMigration)();
+const EepromDataMigration EEPROM_DATA_MIGRATIONS[] = { //indexed by the data version a migration upgrades from; the history of this code starts at v3, so v1 and v2 images have no known layout and are reset to defaults
+  NULL,
+  NULL,
+  NULL,
+  migrateEepromDataV3ToV4
+};
+
+bool migrateEepromData() { //runs the whole chain up to EEPROM_FLASH_DATA_VERSION as one commit; returns false when some step is missing
+  if( eepromFlashDataVersion >= EEPROM_FLASH_DATA_VERSION ) return false;
+  for( uint8_t version = eepromFlashDataVersion; version < EEPROM_FLASH_DATA_VERSION; version++ ) {
+    if( version >= sizeof(EEPROM_DATA_MIGRATIONS) / sizeof(EEPROM_DATA_MIGRATIONS[0]) || EEPROM_DATA_MIGRATIONS[version] == NULL ) return false;
+  }
+
+  writeToSerial( String( F("Migrating settings from version ") ) + String( eepromFlashDataVersion ), true );
+  beginEepromTransaction();
+  for( uint8_t version = eepromFlashDataVersion; version < EEPROM_FLASH_DATA_VERSION; version++ ) {
+    EEPROM_DATA_MIGRATIONS[version]();
+  }
+  writeEepromUint8Value( eepromFlashDataVersionIndex, EEPROM_FLASH_DATA_VERSION );
+  eepromFlashDataVersion = EEPROM_FLASH_DATA_VERSION;
+  commitEepromTransaction();
+  return true;
+}
+
 void loadEepromData() {
   if( eepromFlashDataVersion != 255 ) {
     readEepromUint8Value( eepromFlashDataVersionIndex, eepromFlashDataVersion, true );
   }
 
+  if( eepromFlashDataVersion != 255 && eepromFlashDataVersion < EEPROM_FLASH_DATA_VERSION ) {
+    migrateEepromData();
+  }
+
   if( eepromFlashDataVersion != 255 && eepromFlashDataVersion == EEPROM_FLASH_DATA_VERSION ) {
 
-    readEepromCharArray( eepromWiFiSsidIndex, wiFiClientSsid, sizeof(wiFiClientSsid), true );
-    readEepromCharArray( eepromWiFiPasswordIndex, wiFiClientPassword, sizeof(wiFiClientPassword), true );
+    for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+      WiFiCredential& credential = wiFiCredentials[i];
+      readEepromCharArray( getEepromWiFiSsidIndex( i ), credential.ssid, sizeof(credential.ssid), true );
+      credential.ssid[sizeof(credential.ssid) - 1] = '\0';
+      readEepromCharArray( getEepromWiFiPasswordIndex( i ), credential.password, sizeof(credential.password), true );
+      credential.password[sizeof(credential.password) - 1] = '\0';
+      readEepromUint8Value( getEepromWiFiSuccessRankIndex( i ), credential.successRank, true );
+      if( credential.successRank >= WIFI_CREDENTIALS_COUNT ) credential.successRank = i;
+    }
     char deviceNameReceived[sizeof(deviceName)];
     char deviceNameSanitized[sizeof(deviceName)];
     readEepromCharArray( eepromDeviceNameIndex, deviceNameReceived, sizeof(deviceNameReceived), true );
@@ -460,52 +763,25 @@ void loadEepromData() {
     sanitizeTextAscii( String(deviceNameReceived), deviceNameSanitized, sizeof(deviceNameSanitized) - 1 );
     strncpy(deviceName, deviceNameSanitized, sizeof(deviceNameSanitized) - 1);
     deviceName[sizeof(deviceName) - 1] = '\0';
-    readEepromUint8Value( eepromDisplayFontTypeNumberIndex, displayFontTypeNumber, true );
-    if( displayFontTypeNumber < 1 || displayFontTypeNumber > TCFonts::NUMBER_OF_FONTS_SUPPORTED ) displayFontTypeNumber = 1;
-    readEepromBoolValue( eepromIsFontBoldUsedIndex, isDisplayBoldFontUsed, true );
-    readEepromBoolValue( eepromIsDisplaySecondsShownIndex, isDisplaySecondsShown, true );
-    readEepromUint8Value( eepromDisplayDayBrightnessIndex, displayDayBrightness, true );
-    if( displayDayBrightness > 15 ) displayDayBrightness = 15;
-    readEepromUint8Value( eepromDisplayNightBrightnessIndex, displayNightBrightness, true );
-    if( displayNightBrightness > 15 ) displayNightBrightness = 15;
-    if( displayNightBrightness > displayDayBrightness ) displayNightBrightness = displayDayBrightness;
-    readEepromUint16Value( eepromSensorBrightnessDayLevelIndex, sensorBrightnessDayLevel, true );
-    if( sensorBrightnessDayLevel >= ADC_NUMBER_OF_VALUES ) sensorBrightnessDayLevel = ADC_NUMBER_OF_VALUES - 1;
-    readEepromUint16Value( eepromSensorBrightnessNightLevelIndex, sensorBrightnessNightLevel, true );
-    if( sensorBrightnessNightLevel >= ADC_NUMBER_OF_VALUES ) sensorBrightnessNightLevel = 0;
-    if( sensorBrightnessNightLevel > sensorBrightnessDayLevel ) sensorBrightnessNightLevel = sensorBrightnessDayLevel;
-    readEepromUint8Value( eepromBrightnessSteepnessCoefficientIndex, brightnessSteepnessCoefficient, true );
-    readEepromBoolValue( eepromIsSingleDigitHourShownIndex, isSingleDigitHourShown, true );
-    readEepromBoolValue( eepromIsRotateDisplayIndex, isRotateDisplay, true );
-    readEepromBoolValue( eepromIsSlowSemicolonAnimationIndex, isSlowSemicolonAnimation, true );
-    readEepromBoolValue( eepromIsClockAnimatedIndex, isClockAnimated, true );
-    readEepromUint8Value( eepromAnimationTypeNumberIndex, animationTypeNumber, true );
-    if( animationTypeNumber < 1 || animationTypeNumber > TCData::NUMBER_OF_ANIMATIONS_SUPPORTED ) animationTypeNumber = 1;
-    readEepromBoolValue( eepromIsCompactLayoutShownIndex, isDisplayCompactLayoutUsed, true );
+    readEepromClockSettings();
     readEepromFontData();
 
   } else { //fill EEPROM with default values when starting the new board
+    beginEepromTransaction();
     writeEepromUint8Value( eepromFlashDataVersionIndex, EEPROM_FLASH_DATA_VERSION );
     eepromFlashDataVersion = EEPROM_FLASH_DATA_VERSION;
 
-    writeEepromCharArray( eepromWiFiSsidIndex, wiFiClientSsid, sizeof(wiFiClientSsid) );
-    writeEepromCharArray( eepromWiFiPasswordIndex, wiFiClientPassword, sizeof(wiFiClientPassword) );
+    for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+      WiFiCredential& credential = wiFiCredentials[i];
+      credential.successRank = i;
+      writeEepromCharArray( getEepromWiFiSsidIndex( i ), credential.ssid, sizeof(credential.ssid) );
+      writeEepromCharArray( getEepromWiFiPasswordIndex( i ), credential.password, sizeof(credential.password) );
+      writeEepromUint8Value( getEepromWiFiSuccessRankIndex( i ), credential.successRank );
+    }
     writeEepromCharArray( eepromDeviceNameIndex, deviceName, sizeof(deviceName) );
-    writeEepromUint8Value( eepromDisplayFontTypeNumberIndex, displayFontTypeNumber );
-    writeEepromBoolValue( eepromIsFontBoldUsedIndex, isDisplayBoldFontUsed );
-    writeEepromBoolValue( eepromIsDisplaySecondsShownIndex, isDisplaySecondsShown );
-    writeEepromUint8Value( eepromDisplayDayBrightnessIndex, displayDayBrightness );
-    writeEepromUint8Value( eepromDisplayNightBrightnessIndex, displayNightBrightness );
-    writeEepromUint16Value( eepromSensorBrightnessDayLevelIndex, sensorBrightnessDayLevel );
-    writeEepromUint16Value( eepromSensorBrightnessNightLevelIndex, sensorBrightnessNightLevel );
-    writeEepromUint8Value( eepromBrightnessSteepnessCoefficientIndex, brightnessSteepnessCoefficient );
-    writeEepromBoolValue( eepromIsSingleDigitHourShownIndex, isSingleDigitHourShown );
-    writeEepromBoolValue( eepromIsRotateDisplayIndex, isRotateDisplay );
-    writeEepromBoolValue( eepromIsSlowSemicolonAnimationIndex, isSlowSemicolonAnimation );
-    writeEepromBoolValue( eepromIsClockAnimatedIndex, isClockAnimated );
-    writeEepromUint8Value( eepromAnimationTypeNumberIndex, animationTypeNumber );
-    writeEepromBoolValue( eepromIsCompactLayoutShownIndex, isDisplayCompactLayoutUsed );
+    writeEepromClockSettingDefaults();
     writeEepromFontData( true );
+    commitEepromTransaction();
 
     loadEepromData();
   }
@@ -525,7 +801,7 @@ String getFullWiFiSsidName() {
   fullName += " - " + macAddress.substring( macAddress.length() - 4 );
   #endif
   }
-  size_t maxLen = sizeof(wiFiClientSsid) - 1;
+  size_t maxLen = sizeof(WiFiCredential::ssid) - 1;
   if( fullName.length() > maxLen ) {
     fullName = fullName.substring( 0, maxLen );
   }
@@ -551,7 +827,6 @@ void createAccessPoint() {
   String macAddress = String( ESP.getEfuseMac() );
   WiFi.softAP( getFullWiFiSsidName().c_str(), getWiFiAccessPointPassword(), 0, false );
   #endif
-  isWiFiRadioShutDown = false;
   IPAddress accessPointIp = WiFi.softAPIP();
   dnsServer.start( 53, "*", accessPointIp );
   writeToSerial( String( F(" done | IP: ") ) + accessPointIp.toString(), true );
@@ -563,7 +838,6 @@ void shutdownAccessPoint() {
   writeToSerial( F("Shutting down WiFi AP..."), false );
   dnsServer.stop();
   WiFi.softAPdisconnect( true );
-  isWiFiRadioShutDown = false;
   writeToSerial( F(" done"), true );
 }
 
@@ -601,12 +875,24 @@ void initTimeZone() {
 
 
 //display functionality
-void forceDisplaySync() {
-  isForceDisplaySync = true;
-  isForceDisplaySyncDisplayRenderOverride = true;
+#ifdef ESP8266
+void lockDisplay() {}
+void unlockDisplay() {}
+#else //ESP32 or ESP32S2
+SemaphoreHandle_t displayMutex = NULL; //held by the render task for a frame, loop() takes it while it writes to the display or the custom font itself
+
+void lockDisplay() {
+  if( displayMutex == NULL ) return;
+  xSemaphoreTake( displayMutex, portMAX_DELAY );
 }
 
-double displayCurrentBrightness = static_cast<double>(displayNightBrightness);
+void unlockDisplay() {
+  if( displayMutex == NULL ) return;
+  xSemaphoreGive( displayMutex );
+}
+#endif
+
+double displayCurrentBrightness = static_cast<double>(clockSettings.displayNightBrightness);
 double displayPreviousBrightness = -1.0;
 double sensorBrightnessAverage = -1.0;
 int brightnessDiffSustainedMillis = 0;
@@ -623,24 +909,98 @@ void calculateDisplayBrightness() {
   if( isEnergySavingMode ) {
     displayCurrentBrightness = static_cast<double>(0);
   } else {
-    if( sensorBrightnessAverage >= sensorBrightnessDayLevel ) {
-      displayCurrentBrightness = static_cast<double>(displayDayBrightness);
-    } else if( sensorBrightnessAverage <= sensorBrightnessNightLevel ) {
-      displayCurrentBrightness = static_cast<double>(displayNightBrightness);
+    if( sensorBrightnessAverage >= clockSettings.sensorBrightnessDayLevel ) {
+      displayCurrentBrightness = static_cast<double>(clockSettings.displayDayBrightness);
+    } else if( sensorBrightnessAverage <= clockSettings.sensorBrightnessNightLevel ) {
+      displayCurrentBrightness = static_cast<double>(clockSettings.displayNightBrightness);
     } else {
-      float normalizedSensorBrightnessAverage = (float)(sensorBrightnessAverage - sensorBrightnessNightLevel) / ( sensorBrightnessDayLevel - sensorBrightnessNightLevel );
-      float easingCoefficient = 1 - powf( 1 - normalizedSensorBrightnessAverage, brightnessSteepnessCoefficient*brightnessSteepnessCoefficientStep );
-      displayCurrentBrightness = displayNightBrightness + static_cast<double>( (displayDayBrightness - displayNightBrightness ) * easingCoefficient );
-      //displayCurrentBrightness = displayNightBrightness + static_cast<double>( displayDayBrightness - displayNightBrightness ) * ( sensorBrightnessAverage - sensorBrightnessNightLevel ) / ( sensorBrightnessDayLevel - sensorBrightnessNightLevel );
+      float normalizedSensorBrightnessAverage = (float)(sensorBrightnessAverage - clockSettings.sensorBrightnessNightLevel) / ( clockSettings.sensorBrightnessDayLevel - clockSettings.sensorBrightnessNightLevel );
+      float easingCoefficient = 1 - powf( 1 - normalizedSensorBrightnessAverage, clockSettings.brightnessSteepnessCoefficient*brightnessSteepnessCoefficientStep );
+      displayCurrentBrightness = clockSettings.displayNightBrightness + static_cast<double>( (clockSettings.displayDayBrightness - clockSettings.displayNightBrightness ) * easingCoefficient );
+      //displayCurrentBrightness = clockSettings.displayNightBrightness + static_cast<double>( clockSettings.displayDayBrightness - clockSettings.displayNightBrightness ) * ( sensorBrightnessAverage - clockSettings.sensorBrightnessNightLevel ) / ( clockSettings.sensorBrightnessDayLevel - clockSettings.sensorBrightnessNightLevel );
     }
   }
 }
 
-void setDisplayBrightness( uint8_t displayNewBrightness ) {
+void writeDisplayBrightness( uint8_t displayNewBrightness ) { //talks to the display directly, only the renderer calls it once it runs
   display.control( MD_MAX72XX::INTENSITY, displayNewBrightness );
   display.control( MD_MAX72XX::UPDATE, MD_MAX72XX::OFF );
 }
 
+//loop() hands display changes to the renderer as commands, so the display is driven from one place
+const uint8_t DISPLAY_COMMAND_RENDER = 0;
+const uint8_t DISPLAY_COMMAND_SET_BRIGHTNESS = 1;
+
+struct DisplayCommand {
+  uint8_t type;
+  uint8_t value;
+};
+
+void applyDisplayCommand( const DisplayCommand& command ) {
+  switch( command.type ) {
+    case DISPLAY_COMMAND_RENDER:
+      #ifdef ESP8266
+      scheduler.rescheduleTask( displayRenderTaskId, 0 );
+      #else //ESP32 or ESP32S2
+      //the render task renders right after applying commands
+      #endif
+      break;
+    case DISPLAY_COMMAND_SET_BRIGHTNESS:
+      writeDisplayBrightness( command.value );
+      break;
+    default:
+      break;
+  }
+}
+
+#ifdef ESP8266
+void postDisplayCommand( uint8_t type, uint8_t value ) { //the renderer runs from loop() as well
+  DisplayCommand command = { type, value };
+  applyDisplayCommand( command );
+}
+#else //ESP32 or ESP32S2
+TCSpscQueue<DisplayCommand, 16> displayCommandQueue; //loop() is the only producer, the render task is the only consumer
+TaskHandle_t displayRenderTaskHandle = NULL;
+uint32_t displayCommandOverflowCount = 0; //commands that found the queue full, written by loop() only
+std::atomic<int16_t> overflowDisplayBrightness( -1 ); //latest brightness that found the queue full, applied by the render task after the queue; -1 if none
+
+void postDisplayCommand( uint8_t type, uint8_t value ) { //never waits for the render task, loop() keeps running when it is stalled
+  DisplayCommand command = { type, value };
+  if( displayRenderTaskHandle == NULL ) { //setup() before the render task is started
+    applyDisplayCommand( command );
+    return;
+  }
+  if( type == DISPLAY_COMMAND_SET_BRIGHTNESS ) { //a newer brightness supersedes the one kept from an overflow
+    overflowDisplayBrightness.store( -1 );
+  }
+  if( !displayCommandQueue.push( command ) ) { //a render is pending anyway while the queue is not empty, only the latest brightness has to be kept
+    displayCommandOverflowCount++;
+    if( type == DISPLAY_COMMAND_SET_BRIGHTNESS ) {
+      overflowDisplayBrightness.store( value );
+    }
+  }
+  xTaskNotifyGive( displayRenderTaskHandle );
+}
+#endif
+
+void requestDisplayRender() {
+  postDisplayCommand( DISPLAY_COMMAND_RENDER, 0 );
+}
+
+void forceDisplaySync() { //renders right away, so the colon and the render deadlines follow a clock that has just been set; also called from the SNTP callback, which is not the producer of the command queue
+  #ifdef ESP8266
+  requestDisplayRender();
+  #else //ESP32 or ESP32S2
+  if( displayRenderTaskHandle != NULL ) { //the render task renders its first frame right away otherwise
+    xTaskNotifyGive( displayRenderTaskHandle );
+  }
+  #endif
+}
+
+void setDisplayBrightness( uint8_t displayNewBrightness ) {
+  postDisplayCommand( DISPLAY_COMMAND_SET_BRIGHTNESS, displayNewBrightness );
+}
+
 void setDisplayBrightness( bool isInit ) {
   bool updateDisplayBrightness = false;
   uint8_t displayCurrentBrightnessInt = static_cast<uint8_t>( round( displayCurrentBrightness ) );
@@ -677,8 +1037,13 @@ void setDisplayBrightness( bool isInit ) {
 }
 
 void initDisplayPhase1() {
+  #ifdef ESP8266
+
+  #else //ESP32 or ESP32S2
+  displayMutex = xSemaphoreCreateMutex();
+  #endif
   display.begin();
-  display.control( MD_MAX72XX::INTENSITY, 0 );
+  writeDisplayBrightness( 0 );
   display.clear();
 }
 
@@ -688,37 +1053,92 @@ void initDisplayPhase2() {
   display.clear();
 }
 
+bool isDisplayBrightnessOverridden = false; //set while a display test holds its own brightness
+
 void brightnessProcessLoopTick() {
-  if( calculateDiffMillis( previousMillisSensorBrightnessCheck, millis() ) >= DELAY_SENSOR_BRIGHTNESS_UPDATE_CHECK ) {
-    calculateDisplayBrightness();
-    setDisplayBrightness( false );
-    previousMillisSensorBrightnessCheck = millis();
-  }
+  calculateDisplayBrightness();
+  if( isDisplayBrightnessOverridden ) return;
+  setDisplayBrightness( false );
 }
 
-const uint8_t DISPLAY_WIDTH = 32;
-const uint8_t DISPLAY_HEIGHT = 8;
+const uint8_t DISPLAY_WIDTH = TCLayout::DISPLAY_WIDTH;
+const uint8_t DISPLAY_HEIGHT = TCLayout::DISPLAY_HEIGHT;
+
+uint32_t displayFrameBuffer[DISPLAY_HEIGHT]; //one word per row from top to bottom, bit 31 is the leftmost column
+
+typedef void (*GetDisplayRegistersKernel)( const uint32_t* frameBuffer, uint8_t (*displayRegisters)[DISPLAY_HEIGHT] );
+
+struct DisplayRenderConfig { //derived by the renderer from a settings snapshot, rebuilt when the snapshot version changes
+  uint32_t settingsVersion;
+  TCAnimations::Animation animation; //descriptor of the selected animation type, copied out of the registry
+  unsigned long animationLengthMillis;
+  GetDisplayRegistersKernel getDisplayRegistersKernel; //instance of getDisplayRegisters() for the display rotation
+};
+
+DisplayRenderConfig displayRenderConfig = {};
 
 String textToDisplayLargeAnimated = "";
 bool isDisplayAnimationInProgress = false;
 unsigned long displayAnimationStartedMillis;
-const unsigned long displayAnimationStepLengthMillis = 40;
 
 void cancelDisplayAnimation() {
   textToDisplayLargeAnimated = "";
   isDisplayAnimationInProgress = false;
 }
 
-bool isSemicolonShown = true;
-void renderDisplayText( String hourStr, String minuteStr, String secondStr, bool doAnimate ) {
-  unsigned long currentMillis = millis();
+bool isCharAnimatable( char charToDisplay ) {
+  const char charsAnimatable[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  for( uint8_t i = 0; i < sizeof(charsAnimatable) / sizeof(charsAnimatable[0]); i++ ) {
+    if( charToDisplay == charsAnimatable[i] ) return true;
+  }
+  return false;
+}
+
+//animations pick every display row of the changed digits from the new or the previous frame, all digits at once
+static_assert( DISPLAY_HEIGHT == TCFonts::FONT_HEIGHT, "Animated rows assume the symbol fills the display height" );
 
-  char charsAnimatable[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
-  uint8_t charsAnimatableCount = sizeof(charsAnimatable) / sizeof(charsAnimatable[0]);
-  unsigned long displayAnimationLengthMillis = TCFonts::FONT_HEIGHT * displayAnimationStepLengthMillis;
-  if( animationTypeNumber == 1 || animationTypeNumber == 2 || animationTypeNumber == 4 ) {
-    displayAnimationLengthMillis += displayAnimationStepLengthMillis;
+void animateDisplayRows( uint32_t* rows, const uint32_t* rowsPrevious, uint32_t animatedColumns, const uint8_t* rowSources ) {
+  uint32_t sourceRows[TCAnimations::ROW_SOURCES]; //new frame rows, previous frame rows and a blank row, indexed by row source
+  static_assert( TCAnimations::ROW_COUNT == DISPLAY_HEIGHT, "Animation descriptors map every display row" );
+  memcpy( &sourceRows[0], rows, sizeof(uint32_t) * DISPLAY_HEIGHT );
+  memcpy( &sourceRows[TCAnimations::ROW_PREVIOUS], rowsPrevious, sizeof(uint32_t) * DISPLAY_HEIGHT );
+  sourceRows[TCAnimations::ROW_BLANK] = 0;
+  for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
+    rows[displayY] = ( rows[displayY] & ~animatedColumns ) | ( sourceRows[rowSources[displayY]] & animatedColumns );
   }
+}
+
+TCGlyphCache displayGlyphCache; //symbol images in the display style, rebuilt when the style changes
+
+class DisplayCanvas : public TCRowCanvas { //MAX7219 framebuffer target, collects the previous image and columns of digits changed while the animation is running
+
+  public:
+    DisplayCanvas( uint32_t* rows, uint32_t* rowsPrevious ) : TCRowCanvas( rows ), rowsPrevious( rowsPrevious ), animatedColumns( 0 ) {}
+
+    void drawSymbol( const TCLayoutStyle& style, const TCGlyphPlacement& placement ) override {
+      char charToDisplay = placement.symbol;
+      drawSymbolLines( rows, displayGlyphCache.getSymbol( style, charToDisplay, placement.isSmall ), placement );
+      if( !isDisplayAnimationInProgress || placement.isSmall || !isCharAnimatable( charToDisplay ) || placement.textIndex >= textToDisplayLargeAnimated.length() ) return;
+      char charToDisplayPrevious = textToDisplayLargeAnimated.charAt( placement.textIndex );
+      if( charToDisplay == charToDisplayPrevious ) return;
+
+      drawSymbolLines( rowsPrevious, displayGlyphCache.getSymbol( style, charToDisplayPrevious, false ), placement );
+      animatedColumns |= getColumnsMask( placement.x, placement.width );
+    }
+
+    uint32_t getAnimatedColumns() const {
+      return animatedColumns;
+    }
+
+  private:
+    uint32_t* rowsPrevious;
+    uint32_t animatedColumns;
+
+};
+
+bool isSemicolonShown = true;
+void renderDisplayText( const ClockSettings& settings, String hourStr, String minuteStr, String secondStr, bool doAnimate ) {
+  unsigned long currentMillis = millis();
 
   String textToDisplayLarge = hourStr + ( isSemicolonShown ? ":" : "\t" ) + minuteStr;
   String textToDisplaySmall = secondStr;
@@ -734,13 +1154,7 @@ void renderDisplayText( String hourStr, String minuteStr, String secondStr, bool
       bool doAnimate = false;
       for( size_t charToDisplayIndex = 0; charToDisplayIndex < textToDisplayLarge.length(); ++charToDisplayIndex ) {
         char charToDisplay = textToDisplayLarge.charAt( charToDisplayIndex );
-        bool isAnimatable = false;
-        for( uint8_t i = 0; i < charsAnimatableCount; i++ ) {
-          if( charToDisplay != charsAnimatable[i] ) continue;
-          isAnimatable = true;
-          break;
-        }
-        if( !isAnimatable || textToDisplayLargeAnimated.charAt( charToDisplayIndex ) == charToDisplay ) continue;
+        if( !isCharAnimatable( charToDisplay ) || textToDisplayLargeAnimated.charAt( charToDisplayIndex ) == charToDisplay ) continue;
         doAnimate = true;
         break;
       }
@@ -751,202 +1165,85 @@ void renderDisplayText( String hourStr, String minuteStr, String secondStr, bool
     } else {
       textToDisplayLargeAnimated = textToDisplayLarge;
     }
-  } else if( isDisplayAnimationInProgress && calculateDiffMillis( displayAnimationStartedMillis, currentMillis ) > displayAnimationLengthMillis ) {
+  } else if( isDisplayAnimationInProgress && calculateDiffMillis( displayAnimationStartedMillis, currentMillis ) > displayRenderConfig.animationLengthMillis ) {
     isDisplayAnimationInProgress = false;
     textToDisplayLargeAnimated = textToDisplayLarge;
   }
 
-  uint8_t displayWidthUsed = 0;
-  bool isWideTextRendered = !isDisplaySecondsShown;
-
-  for( size_t charToDisplayIndex = 0; charToDisplayIndex < textToDisplayLarge.length(); ++charToDisplayIndex ) {
-    char charToDisplay = textToDisplayLarge.charAt( charToDisplayIndex );
-
-    uint8_t charLpWidth = TCFonts::getSymbolLp( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, false );
-    uint8_t charWidth = TCFonts::getSymbolWidth( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, false );
-    uint8_t charRpWidth = TCFonts::getSymbolRp( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, false );
+  uint8_t currentAnimationStep = 0;
+  if( isDisplayAnimationInProgress ) { //all animated symbols share the same step, so it is calculated once per frame
+    currentAnimationStep = TCAnimations::getAnimationStep( displayRenderConfig.animation, calculateDiffMillis( displayAnimationStartedMillis, currentMillis ) );
+  }
 
-    if( displayWidthUsed + charLpWidth > DISPLAY_WIDTH ) {
-      charLpWidth = DISPLAY_WIDTH - displayWidthUsed;
-    }
-    if( displayWidthUsed + charLpWidth + charWidth > DISPLAY_WIDTH ) {
-      charWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth;
-    }
-    if( displayWidthUsed + charLpWidth + charWidth + charRpWidth > DISPLAY_WIDTH ) {
-      charRpWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth - charWidth;
-    }
+  uint32_t displayFrameBufferPrevious[DISPLAY_HEIGHT] = {};
+  DisplayCanvas displayCanvas( displayFrameBuffer, displayFrameBufferPrevious );
+  TCLayoutStyle style = { settings.displayFontTypeNumber, settings.isDisplayCompactLayoutUsed, settings.isDisplayBoldFontUsed, !settings.isDisplaySecondsShown };
+  TCLayout::render( displayCanvas, style, textToDisplayLarge, textToDisplaySmall, settings.isDisplaySecondsShown );
+  if( displayCanvas.getAnimatedColumns() != 0 ) {
+    animateDisplayRows( displayFrameBuffer, displayFrameBufferPrevious, displayCanvas.getAnimatedColumns(), displayRenderConfig.animation.rowSources[currentAnimationStep] );
+  }
+}
 
-    if( charWidth == 0 ) continue;
+uint32_t reverseBits32( uint32_t x ) {
+  x = ( ( x >> 1 ) & 0x55555555 ) | ( ( x & 0x55555555 ) << 1 );
+  x = ( ( x >> 2 ) & 0x33333333 ) | ( ( x & 0x33333333 ) << 2 );
+  x = ( ( x >> 4 ) & 0x0F0F0F0F ) | ( ( x & 0x0F0F0F0F ) << 4 );
+  x = ( ( x >> 8 ) & 0x00FF00FF ) | ( ( x & 0x00FF00FF ) << 8 );
+  return ( x >> 16 ) | ( x << 16 );
+}
 
-    for( uint8_t charX = 0; charX < charLpWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        display.setPoint(
-          isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-          isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-          false
-        );
-      }
-      displayWidthUsed++;
-    }
+uint8_t displayRegistersSent[MAX_MAX_DEVICES][DISPLAY_HEIGHT]; //shadow copy of the digit registers last sent to each device
+bool isDisplayRegistersSentValid = false;
+uint32_t displayBytesSentCount = 0;
+uint32_t displayBytesSavedCount = 0;
 
-    std::vector<uint8_t> charImage = TCFonts::getSymbol( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isDisplayBoldFontUsed, isWideTextRendered, false, false );
-    std::vector<uint8_t> charImagePrevious;
-    if( isDisplayAnimationInProgress ) {
-      bool isAnimatable = false;
-      for( uint8_t i = 0; i < charsAnimatableCount; i++ ) {
-        if( charToDisplay != charsAnimatable[i] ) continue;
-        isAnimatable = true;
-        break;
-      }
-      if( isAnimatable && charToDisplayIndex < textToDisplayLargeAnimated.length() ) {
-        char charToDisplayPrevious = textToDisplayLargeAnimated.charAt( charToDisplayIndex );
-        if( charToDisplay != charToDisplayPrevious ) {
-          charImagePrevious = TCFonts::getSymbol( displayFontTypeNumber, charToDisplayPrevious, isDisplayCompactLayoutUsed, isDisplayBoldFontUsed, isWideTextRendered, false, false );
-        }
-      }
-    }
+void invalidateDisplayRegistersSent() { //call when the devices were written bypassing pushDisplayFrameBuffer()
+  isDisplayRegistersSentValid = false;
+}
 
-    for( uint8_t charX = 0; charX < charWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        bool isPointEnabled = false;
-        uint8_t charShiftY = DISPLAY_HEIGHT - charImage.size();
-        if( displayY >= charShiftY ) {
-          uint8_t charY = displayY - charShiftY;
-          isPointEnabled = ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1;
-          if( isDisplayAnimationInProgress && charImagePrevious.size() > 0 ) {
-            uint8_t animationSteps = charImage.size();
-            if( animationTypeNumber == 1 || animationTypeNumber == 2 || animationTypeNumber == 4 ) {
-              animationSteps++;
-            }
-            unsigned long animationStepSize = displayAnimationLengthMillis / animationSteps;
-            int currentAnimationStep = calculateDiffMillis( displayAnimationStartedMillis, currentMillis ) / animationStepSize;
-            if( currentAnimationStep >= animationSteps ) {
-              currentAnimationStep = animationSteps - 1;
-            }
-            if( animationTypeNumber == 1 ) {
-              isPointEnabled = currentAnimationStep == charY
-                               ? 0
-                               : ( currentAnimationStep < charY
-                                 ? ( ( charImagePrevious[charY - currentAnimationStep - 1] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 )
-                                 : ( ( charImage[charY + charImage.size() - currentAnimationStep] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 ) );
-            } else if( animationTypeNumber == 2 ) {
-              isPointEnabled = currentAnimationStep == charY
-                               ? 0
-                               : ( currentAnimationStep < charY
-                                   ? ( ( charImagePrevious[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 )
-                                   : ( ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 ) );
-
-            } else if( animationTypeNumber == 3 ) {
-              isPointEnabled = currentAnimationStep < charY
-                                ? ( ( charImagePrevious[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 )
-                                : ( ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 );
-            } else if( animationTypeNumber == 4 ) {
-              isPointEnabled = currentAnimationStep == charY
-                               ? 0
-                               : ( currentAnimationStep < charY
-                                 ? ( ( charImagePrevious[charY - currentAnimationStep - 1] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 )
-                                 : ( ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 ) );
-            } else if( animationTypeNumber == 5 ) {
-              isPointEnabled = ( currentAnimationStep < charY
-                                ? ( ( charImagePrevious[charY - currentAnimationStep - 1] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 )
-                                : ( ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1 ) );
-            }
-          }
-        }
-        display.setPoint(
-          isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-          isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-          isPointEnabled
-        );
-      }
-      displayWidthUsed++;
-    }
-
-    for( uint8_t charX = 0; charX < charRpWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        display.setPoint(
-          isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-          isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-          false
-        );
-      }
-      displayWidthUsed++;
+template<bool IS_ROTATED> void getDisplayRegisters( const uint32_t* frameBuffer, uint8_t (*displayRegisters)[DISPLAY_HEIGHT] ) { //instantiated per rotation, so the row loop has no branch on the setting
+  for( uint8_t row = 0; row < DISPLAY_HEIGHT; ++row ) { //device 0 holds the rightmost columns, bit 0 of a register is the rightmost column of a device
+    uint32_t rowBits = IS_ROTATED ? reverseBits32( frameBuffer[DISPLAY_HEIGHT - 1 - row] ) : frameBuffer[row];
+    for( uint8_t device = 0; device < MAX_MAX_DEVICES; ++device ) {
+      displayRegisters[device][row] = rowBits >> ( device * 8 );
     }
   }
+}
 
-  if( isDisplaySecondsShown ) {
-    for( size_t charToDisplayIndex = 0; charToDisplayIndex < textToDisplaySmall.length(); ++charToDisplayIndex ) {
-      char charToDisplay = textToDisplaySmall.charAt( charToDisplayIndex );
-
-      uint8_t charLpWidth = TCFonts::getSymbolLp( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, true );
-      uint8_t charWidth = TCFonts::getSymbolWidth( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, true );
-      uint8_t charRpWidth = TCFonts::getSymbolRp( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isWideTextRendered, true );
-
-      if( displayWidthUsed + charLpWidth > DISPLAY_WIDTH ) {
-        charLpWidth = DISPLAY_WIDTH - displayWidthUsed;
-      }
-      if( displayWidthUsed + charLpWidth + charWidth > DISPLAY_WIDTH ) {
-        charWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth;
-      }
-      if( displayWidthUsed + charLpWidth + charWidth + charRpWidth > DISPLAY_WIDTH ) {
-        charRpWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth - charWidth;
-      }
-      
-      if( charWidth == 0 ) continue;
-
-      for( uint8_t charX = 0; charX < charLpWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          display.setPoint(
-            isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-            isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-            false
-          );
-        }
-        displayWidthUsed++;
-      }
+void updateDisplayRenderConfig( const ClockSettings& settings ) { //call with every snapshot the renderer reads
+  if( displayRenderConfig.settingsVersion == settings.version ) return;
+  if( !TCAnimations::getAnimation( settings.animationTypeNumber, displayRenderConfig.animation ) ) {
+    TCAnimations::getAnimation( 1, displayRenderConfig.animation );
+  }
+  displayRenderConfig.animationLengthMillis = TCAnimations::getAnimationLength( displayRenderConfig.animation );
+  displayRenderConfig.getDisplayRegistersKernel = settings.isRotateDisplay ? &getDisplayRegisters<true> : &getDisplayRegisters<false>;
+  displayRenderConfig.settingsVersion = settings.version;
+}
 
-      std::vector<uint8_t> charImage = TCFonts::getSymbol( displayFontTypeNumber, charToDisplay, isDisplayCompactLayoutUsed, isDisplayBoldFontUsed, isWideTextRendered, true, false );
-      for( uint8_t charX = 0; charX < charWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          bool isPointEnabled = false;
-          uint8_t charShiftY = DISPLAY_HEIGHT - charImage.size();
-          if( displayY >= charShiftY ) {
-            uint8_t charY = displayY - charShiftY;
-            isPointEnabled = ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1;
-          }
-          display.setPoint(
-            isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-            isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-            isPointEnabled
-          );
-        }
-        displayWidthUsed++;
-      }
+void pushDisplayFrameBuffer() { //only the digit registers that differ from the previous frame go out on SPI; unchanged frames skip the bus entirely
+  uint8_t displayRegisters[MAX_MAX_DEVICES][DISPLAY_HEIGHT];
+  displayRenderConfig.getDisplayRegistersKernel( displayFrameBuffer, displayRegisters );
 
-      for( uint8_t charX = 0; charX < charRpWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          display.setPoint(
-            isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - displayY ) : ( displayY ),
-            isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-            false
-          );
-        }
-        displayWidthUsed++;
-      }
+  const uint16_t bytesPerRowUpdate = MAX_MAX_DEVICES * 2; //every device in the chain receives a register or a no-op when one row is updated
+  uint16_t bytesSent = 0;
+  for( uint8_t row = 0; row < DISPLAY_HEIGHT; ++row ) {
+    bool isRowChanged = false;
+    for( uint8_t device = 0; device < MAX_MAX_DEVICES; ++device ) {
+      if( isDisplayRegistersSentValid && displayRegistersSent[device][row] == displayRegisters[device][row] ) continue;
+      display.setRow( device, row, displayRegisters[device][row] );
+      displayRegistersSent[device][row] = displayRegisters[device][row];
+      isRowChanged = true;
+    }
+    if( isRowChanged ) {
+      bytesSent += bytesPerRowUpdate;
     }
   }
+  isDisplayRegistersSentValid = true;
 
-  if( displayWidthUsed < DISPLAY_WIDTH ) { //fill the rest of the screen
-    for( uint8_t charX = 0; charX < DISPLAY_WIDTH - displayWidthUsed + 1; ++charX ) {
-      for( uint8_t charY = 0; charY < DISPLAY_HEIGHT; ++charY ) {
-        display.setPoint(
-          isRotateDisplay ? ( DISPLAY_HEIGHT - 1 - charY ) : ( charY ),
-          isRotateDisplay ? displayWidthUsed : ( DISPLAY_WIDTH - 1 - displayWidthUsed ),
-          false
-        );
-      }
-      displayWidthUsed++;
-    }
+  displayBytesSentCount += bytesSent;
+  displayBytesSavedCount += DISPLAY_HEIGHT * bytesPerRowUpdate - bytesSent;
+  if( bytesSent > 0 ) {
+    display.update();
   }
 }
 
@@ -971,126 +1268,264 @@ void calculateTimeToShow( String& hourStr, String& minuteStr, String& secondStr,
   }
 }
 
-std::vector<std::vector<bool>> getDisplayPreview( String hourStrPreview, String minuteStrPreview, String secondStrPreview, uint8_t fontNumberPreview, bool isBoldPreview, bool isSecondsShownPreview, bool isCompactLayoutPreview ) {
-  std::vector<std::vector<bool>> preview( DISPLAY_HEIGHT, std::vector<bool>( DISPLAY_WIDTH, false ) );
+void getDisplayPreview( uint32_t (&preview)[DISPLAY_HEIGHT], String hourStrPreview, String minuteStrPreview, String secondStrPreview, uint8_t fontNumberPreview, bool isBoldPreview, bool isSecondsShownPreview, bool isCompactLayoutPreview ) {
+  TCRowCanvas previewCanvas( preview );
+  TCLayoutStyle style = { fontNumberPreview, isCompactLayoutPreview, isBoldPreview, !isSecondsShownPreview };
+  TCLayout::render( previewCanvas, style, hourStrPreview + ":" + minuteStrPreview, secondStrPreview, isSecondsShownPreview );
+}
 
-  String textToDisplayLargePreview = hourStrPreview + ":" + minuteStrPreview;
-  String textToDisplaySmallPreview = secondStrPreview;
+#ifdef ESP8266
+typedef uint32_t RenderStatsCounter;
+#else //ESP32 or ESP32S2
+typedef std::atomic<uint32_t> RenderStatsCounter; //counted by the render task, read and reset by loop()
+#endif
+RenderStatsCounter displayRendersCount( 0 ); //renders in the current stats window
+RenderStatsCounter displayRenderWakeupsCount( 0 ); //times the renderer woke up in the current stats window, including the wakeups that rendered nothing
+uint32_t loopsCount = 0; //loop() runs in the current stats window
+uint32_t idleLoopsCount = 0; //loop() runs in the current stats window in which no scheduler task was due
+uint32_t displayRendersPerMinute = 0;
+float displayRenderWakeupsPerSecond = 0;
+uint8_t idleLoopsPercent = 0;
+
+uint32_t takeRenderStatsCounter( RenderStatsCounter& counter ) { //returns the count and starts the next window from 0
+  #ifdef ESP8266
+  uint32_t count = counter;
+  counter = 0;
+  return count;
+  #else //ESP32 or ESP32S2
+  return counter.exchange( 0 );
+  #endif
+}
 
-  uint8_t displayWidthUsed = 0;
-  bool isWideTextPreview = !isSecondsShownPreview;
+void renderStatsProcessLoopTick() { //periodic task, the scheduler keeps its cadence, so every window is DELAY_RENDER_STATS_WINDOW long
+  displayRendersPerMinute = (uint64_t)takeRenderStatsCounter( displayRendersCount ) * 60000 / DELAY_RENDER_STATS_WINDOW;
+  displayRenderWakeupsPerSecond = takeRenderStatsCounter( displayRenderWakeupsCount ) * 1000.0 / DELAY_RENDER_STATS_WINDOW;
+  idleLoopsPercent = loopsCount == 0 ? 0 : (uint64_t)idleLoopsCount * 100 / loopsCount;
+  loopsCount = 0;
+  idleLoopsCount = 0;
+}
 
-  for( size_t charToDisplayIndex = 0; charToDisplayIndex < textToDisplayLargePreview.length(); ++charToDisplayIndex ) {
-    char charToDisplay = textToDisplayLargePreview.charAt( charToDisplayIndex );
+unsigned long getSemicolonPhaseMillis( const ClockSettings& settings, unsigned long currentMillis ) { //time since the colon blink period started; the colon is shown in the first half of the period, which starts at an even second
+  unsigned long epochTimeSeconds = 0;
+  unsigned long epochTimeMillis = 0;
+  if( timeCanBeCalculated() ) {
+    struct timeval timeValue;
+    gettimeofday( &timeValue, NULL );
+    epochTimeSeconds = timeValue.tv_sec;
+    epochTimeMillis = timeValue.tv_usec / 1000;
+  } else {
+    epochTimeSeconds = currentMillis / 1000;
+    epochTimeMillis = currentMillis % 1000;
+  }
+  return settings.isSlowSemicolonAnimation ? ( epochTimeSeconds % 2 ) * 1000 + epochTimeMillis : epochTimeMillis;
+}
 
-    uint8_t charLpWidth = TCFonts::getSymbolLp( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, false );
-    uint8_t charWidth = TCFonts::getSymbolWidth( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, false );
-    uint8_t charRpWidth = TCFonts::getSymbolRp( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, false );
+unsigned long getDisplayRenderDelayMillis( const ClockSettings& settings, unsigned long currentMillis ) { //time until the next colon toggle, digit change or animation step, whichever comes first
+  unsigned long renderDelayMillis = DELAY_DISPLAY_RENDER_MAX;
 
-    if( displayWidthUsed + charLpWidth > DISPLAY_WIDTH ) {
-      charLpWidth = DISPLAY_WIDTH - displayWidthUsed;
-    }
-    if( displayWidthUsed + charLpWidth + charWidth > DISPLAY_WIDTH ) {
-      charWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth;
-    }
-    if( displayWidthUsed + charLpWidth + charWidth + charRpWidth > DISPLAY_WIDTH ) {
-      charRpWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth - charWidth;
-    }
+  unsigned long semicolonAnimationMillis = settings.isSlowSemicolonAnimation ? 1000 : 500;
+  unsigned long millisUntilSemicolonAnimation = semicolonAnimationMillis - getSemicolonPhaseMillis( settings, currentMillis ) % semicolonAnimationMillis;
+  if( millisUntilSemicolonAnimation < renderDelayMillis ) renderDelayMillis = millisUntilSemicolonAnimation;
 
-    if( charWidth == 0 ) continue;
+  if( timeCanBeCalculated() ) {
+    struct timeval timeValue;
+    gettimeofday( &timeValue, NULL );
+    unsigned long millisUntilNextSecond = 1000 - timeValue.tv_usec / 1000;
+    unsigned long millisUntilDigitChange = settings.isDisplaySecondsShown ? millisUntilNextSecond : ( 59 - timeValue.tv_sec % 60 ) * 1000 + millisUntilNextSecond;
+    if( millisUntilDigitChange < renderDelayMillis ) renderDelayMillis = millisUntilDigitChange;
+  }
 
-    for( uint8_t charX = 0; charX < charLpWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        preview[displayY][displayWidthUsed] = false;
-      }
-      displayWidthUsed++;
-    }
+  if( isDisplayAnimationInProgress ) {
+    unsigned long millisUntilAnimationStep = TCAnimations::getMillisUntilNextStep( displayRenderConfig.animation, calculateDiffMillis( displayAnimationStartedMillis, currentMillis ) );
+    if( millisUntilAnimationStep < renderDelayMillis ) renderDelayMillis = millisUntilAnimationStep;
+  }
 
-    std::vector<uint8_t> charImage = TCFonts::getSymbol( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isBoldPreview, isWideTextPreview, false, false );
-    for( uint8_t charX = 0; charX < charWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        bool isPointEnabled = false;
-        uint8_t charShiftY = DISPLAY_HEIGHT - charImage.size();
-        if( displayY >= charShiftY ) {
-          uint8_t charY = displayY - charShiftY;
-          isPointEnabled = ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1;
-        }
-        preview[displayY][displayWidthUsed] = isPointEnabled;
-      }
-      displayWidthUsed++;
-    }
+  return renderDelayMillis;
+}
 
-    for( uint8_t charX = 0; charX < charRpWidth; ++charX ) {
-      for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-        preview[displayY][displayWidthUsed] = false;
-      }
-      displayWidthUsed++;
-    }
+void renderDisplay( const ClockSettings& settings ) {
+  displayRendersCount++;
+  if( timeCanBeCalculated() ) {
+    String hourStr, minuteStr, secondStr;
+    calculateTimeToShow( hourStr, minuteStr, secondStr, settings.isSingleDigitHourShown );
+    renderDisplayText( settings, hourStr, minuteStr, secondStr, settings.isClockAnimated );
+
+  } else {
+    renderDisplayText( settings, "  ", "  ", "  ", false );
   }
+  pushDisplayFrameBuffer();
+}
 
-  if( isSecondsShownPreview ) {
-    for( size_t charToDisplayIndex = 0; charToDisplayIndex < textToDisplaySmallPreview.length(); ++charToDisplayIndex ) {
-      char charToDisplay = textToDisplaySmallPreview.charAt( charToDisplayIndex );
+volatile bool isDisplayRenderPaused = false; //set while the display shows something other than the clock, e.g. a LED test
 
-      uint8_t charLpWidth = TCFonts::getSymbolLp( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, true );
-      uint8_t charWidth = TCFonts::getSymbolWidth( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, true );
-      uint8_t charRpWidth = TCFonts::getSymbolRp( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isWideTextPreview, true );
+unsigned long renderDisplayFrame() { //updates the colon state and renders the clock; returns the time until the next frame is due
+  displayRenderWakeupsCount++;
+  const ClockSettings& settings = publishedClockSettings.read();
+  updateDisplayRenderConfig( settings );
+  if( isDisplayRenderPaused ) return DELAY_DISPLAY_RENDER_MAX;
 
-      if( displayWidthUsed + charLpWidth > DISPLAY_WIDTH ) {
-        charLpWidth = DISPLAY_WIDTH - displayWidthUsed;
-      }
-      if( displayWidthUsed + charLpWidth + charWidth > DISPLAY_WIDTH ) {
-        charWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth;
-      }
-      if( displayWidthUsed + charLpWidth + charWidth + charRpWidth > DISPLAY_WIDTH ) {
-        charRpWidth = DISPLAY_WIDTH - displayWidthUsed - charLpWidth - charWidth;
-      }
+  isSemicolonShown = getSemicolonPhaseMillis( settings, millis() ) < ( settings.isSlowSemicolonAnimation ? 1000 : 500 ); //follows the clock, so a frame rendered late or early never puts the colon out of step
 
-      if( charWidth == 0 ) continue;
+  renderDisplay( settings );
+  return getDisplayRenderDelayMillis( settings, millis() );
+}
 
-      for( uint8_t charX = 0; charX < charLpWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          preview[displayY][displayWidthUsed] = false;
-        }
-        displayWidthUsed++;
-      }
+#ifdef ESP8266
+void displayRenderProcessLoopTick() {
+  scheduler.rescheduleTask( displayRenderTaskId, renderDisplayFrame() );
+}
 
-      std::vector<uint8_t> charImage = TCFonts::getSymbol( fontNumberPreview, charToDisplay, isCompactLayoutPreview, isBoldPreview, isWideTextPreview, true, false );
-      for( uint8_t charX = 0; charX < charWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          bool isPointEnabled = false;
-          uint8_t charShiftY = DISPLAY_HEIGHT - charImage.size();
-          if( displayY >= charShiftY ) {
-            uint8_t charY = displayY - charShiftY;
-            isPointEnabled = ( charImage[charY] >> ( DISPLAY_HEIGHT - 1 - charX ) ) & 1;
-          }
-          preview[displayY][displayWidthUsed] = isPointEnabled;
-        }
-        displayWidthUsed++;
-      }
+void initDisplayRenderTask() {
+  displayRenderTaskId = scheduler.addOneShotTask( "render", displayRenderProcessLoopTick, 0 );
+}
+#else //ESP32 or ESP32S2
+//the display is rendered from its own task, woken by a hardware timer at the next visible change, so a slow web request in loop() does not hold the colon back
+const uint8_t DISPLAY_RENDER_TIMER_NUMBER = 0;
+const uint16_t DISPLAY_RENDER_TIMER_DIVIDER = 80; //80 MHz APB clock / 80 = 1 us timer tick
+const uint32_t DISPLAY_RENDER_TASK_STACK_SIZE = 4096;
+const UBaseType_t DISPLAY_RENDER_TASK_PRIORITY = 20; //above lwIP and loop(), below the WiFi driver
+#if CONFIG_FREERTOS_UNICORE
+const BaseType_t DISPLAY_RENDER_TASK_CORE = 0;
+#else
+const BaseType_t DISPLAY_RENDER_TASK_CORE = 1; //APP core; loop() with the web server and DNS, WiFi and SNTP stay on the PRO core, see ARDUINO_RUNNING_CORE in platformio.ini
+#endif
+hw_timer_t* displayRenderTimer = NULL;
 
-      for( uint8_t charX = 0; charX < charRpWidth; ++charX ) {
-        for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
-          preview[displayY][displayWidthUsed] = false;
-        }
-        displayWidthUsed++;
-      }
+void IRAM_ATTR onDisplayRenderTimer() {
+  BaseType_t isHigherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR( displayRenderTaskHandle, &isHigherPriorityTaskWoken );
+  if( isHigherPriorityTaskWoken ) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void scheduleDisplayRender( unsigned long delayMillis ) {
+  timerAlarmDisable( displayRenderTimer );
+  timerWrite( displayRenderTimer, 0 );
+  timerAlarmWrite( displayRenderTimer, delayMillis == 0 ? 1 : delayMillis * 1000, false );
+  timerAlarmEnable( displayRenderTimer );
+}
+
+void displayRenderTask( void* parameter ) {
+  displayRenderTimer = timerBegin( DISPLAY_RENDER_TIMER_NUMBER, DISPLAY_RENDER_TIMER_DIVIDER, true );
+  timerAttachInterrupt( displayRenderTimer, &onDisplayRenderTimer, true ); //the interrupt is allocated on the calling core, i.e. the one the task is pinned to
+  for( ;; ) {
+    lockDisplay();
+    DisplayCommand command;
+    while( displayCommandQueue.pop( command ) ) {
+      applyDisplayCommand( command );
+    }
+    int16_t brightness = overflowDisplayBrightness.exchange( -1 );
+    if( brightness >= 0 ) {
+      command = { DISPLAY_COMMAND_SET_BRIGHTNESS, (uint8_t)brightness };
+      applyDisplayCommand( command );
     }
+    unsigned long renderDelayMillis = renderDisplayFrame();
+    unlockDisplay();
+    scheduleDisplayRender( renderDelayMillis );
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
   }
+}
 
-  return preview;
+void initDisplayRenderTask() {
+  xTaskCreatePinnedToCore( displayRenderTask, "render", DISPLAY_RENDER_TASK_STACK_SIZE, NULL, DISPLAY_RENDER_TASK_PRIORITY, &displayRenderTaskHandle, DISPLAY_RENDER_TASK_CORE );
 }
+#endif
 
-void renderDisplay() {
-  if( timeCanBeCalculated() ) {
-    String hourStr, minuteStr, secondStr;
-    calculateTimeToShow( hourStr, minuteStr, secondStr, isSingleDigitHourShown );
-    renderDisplayText( hourStr, minuteStr, secondStr, isClockAnimated );
 
-  } else {
-    renderDisplayText( "  ", "  ", "  ", false );
+//display test sequences, stepped by the scheduler so the web server and timekeeping keep running while a test is shown
+const uint8_t DISPLAY_TEST_NONE = 0;
+const uint8_t DISPLAY_TEST_LEDS = 1;
+const uint8_t DISPLAY_TEST_NIGHT = 2;
+const uint16_t DELAY_DISPLAY_TEST_NIGHT = 6000;
+const uint8_t DISPLAY_TEST_LEDS_ROW_STEPS = 8;
+const uint8_t DISPLAY_TEST_LEDS_COLUMN_STEPS = 31;
+const uint8_t DISPLAY_TEST_LEDS_DIAGONAL_STEPS = 4;
+const uint8_t DISPLAY_TEST_LEDS_GRID_STEPS = 4;
+const uint8_t DISPLAY_TEST_LEDS_STEPS = DISPLAY_TEST_LEDS_ROW_STEPS + DISPLAY_TEST_LEDS_COLUMN_STEPS + DISPLAY_TEST_LEDS_DIAGONAL_STEPS + DISPLAY_TEST_LEDS_GRID_STEPS + 1; //the last step lights every LED
+
+uint8_t displayTestType = DISPLAY_TEST_NONE;
+uint8_t displayTestStep = 0;
+
+uint16_t getDisplayTestLedsStepMillis( uint8_t step ) {
+  if( step < DISPLAY_TEST_LEDS_ROW_STEPS ) return 400;
+  step -= DISPLAY_TEST_LEDS_ROW_STEPS;
+  if( step < DISPLAY_TEST_LEDS_COLUMN_STEPS ) return 200;
+  step -= DISPLAY_TEST_LEDS_COLUMN_STEPS;
+  if( step < DISPLAY_TEST_LEDS_DIAGONAL_STEPS + DISPLAY_TEST_LEDS_GRID_STEPS ) return 1500;
+  return 1800;
+}
+
+bool isDisplayTestLedOn( uint8_t step, uint8_t x, uint8_t y ) {
+  if( step < DISPLAY_TEST_LEDS_ROW_STEPS ) return step == y;
+  step -= DISPLAY_TEST_LEDS_ROW_STEPS;
+  if( step < DISPLAY_TEST_LEDS_COLUMN_STEPS ) return step == x;
+  step -= DISPLAY_TEST_LEDS_COLUMN_STEPS;
+  if( step < DISPLAY_TEST_LEDS_DIAGONAL_STEPS ) {
+    uint8_t period = ( step + 1 ) * 2;
+    return x % period == y % period || x % period == period - y % period;
+  }
+  step -= DISPLAY_TEST_LEDS_DIAGONAL_STEPS;
+  if( step < DISPLAY_TEST_LEDS_GRID_STEPS ) return x % 4 == step || y % 4 == step;
+  return true;
+}
+
+void drawDisplayTestLeds( uint8_t step ) {
+  lockDisplay();
+  for( uint8_t y = 0; y < 8; ++y ) {
+    for( uint8_t x = 0; x < 32; ++x ) {
+      display.setPoint( y, 32 - 1 - x, isDisplayTestLedOn( step, x, y ) );
+    }
   }
   display.update();
+  unlockDisplay();
+}
+
+void stopDisplayTest() {
+  if( displayTestType == DISPLAY_TEST_NONE ) return;
+  scheduler.cancelTask( displayTestTaskId );
+  if( displayTestType == DISPLAY_TEST_LEDS ) {
+    invalidateDisplayRegistersSent();
+    isDisplayRenderPaused = false;
+  } else if( displayTestType == DISPLAY_TEST_NIGHT ) {
+    isDisplayBrightnessOverridden = false;
+    setDisplayBrightness( true );
+  }
+  displayTestType = DISPLAY_TEST_NONE;
+  requestDisplayRender();
+}
+
+void startDisplayTest( uint8_t testType ) { //a test that is already running is stopped first
+  stopDisplayTest();
+  displayTestType = testType;
+  displayTestStep = 0;
+  if( displayTestType == DISPLAY_TEST_LEDS ) {
+    isDisplayRenderPaused = true;
+  } else if( displayTestType == DISPLAY_TEST_NIGHT ) {
+    isDisplayBrightnessOverridden = true;
+  }
+  scheduler.rescheduleTask( displayTestTaskId, 0 );
+}
+
+void displayTestProcessLoopTick() {
+  if( displayTestType == DISPLAY_TEST_LEDS ) {
+    if( displayTestStep >= DISPLAY_TEST_LEDS_STEPS ) {
+      stopDisplayTest();
+      return;
+    }
+    drawDisplayTestLeds( displayTestStep );
+    scheduler.rescheduleTask( displayTestTaskId, getDisplayTestLedsStepMillis( displayTestStep ) );
+    displayTestStep++;
+  } else if( displayTestType == DISPLAY_TEST_NIGHT ) {
+    if( displayTestStep > 0 ) {
+      stopDisplayTest();
+      return;
+    }
+    setDisplayBrightness( clockSettings.displayNightBrightness );
+    requestDisplayRender();
+    scheduler.rescheduleTask( displayTestTaskId, DELAY_DISPLAY_TEST_NIGHT );
+    displayTestStep++;
+  }
 }
 
 
@@ -1126,14 +1561,14 @@ void initPowerModePin() {
 #ifdef ESP8266
 
 #else //ESP32 or ESP32S2
-bool isSerialPrintNtpTimeSuccessPending = false;
+std::atomic<bool> isNtpTimeSyncPending( false ); //set by the SNTP callback, handled by ntpProcessLoopTick() in loop()
+unsigned long ntpTimeSyncedMillis = 0;
 void ntpSyncCallback( struct timeval *tv ) {
-  previousMillisNtpStatusCheck = millis();
-
   isNtpTimeSet = true;
   isCustomDateTimeSet = false;
   sntp_set_sync_interval( DELAY_NTP_TIME_SYNC );
-  isSerialPrintNtpTimeSuccessPending = true;
+  isNtpTimeSyncPending = true;
+  forceDisplaySync(); //render deadlines are based on the clock that has just been set
 }
 #endif
 
@@ -1174,10 +1609,11 @@ void ntpProcessLoopTick() {
   #ifdef ESP8266
 
   #else //ESP32 or ESP32S2
-  if( isSerialPrintNtpTimeSuccessPending ) {
-    isSerialPrintNtpTimeSuccessPending = false;
+  if( isNtpTimeSyncPending.exchange( false ) ) {
+    ntpTimeSyncedMillis = millis();
+    scheduler.rescheduleTask( ntpStatusCheckTaskId, DELAY_NTP_STATUS_CHECK );
     String hourStr, minuteStr, secondStr;
-    calculateTimeToShow( hourStr, minuteStr, secondStr, isSingleDigitHourShown );
+    calculateTimeToShow( hourStr, minuteStr, secondStr, clockSettings.isSingleDigitHourShown );
     struct timeval timeValue;
     gettimeofday( &timeValue, NULL );
     writeToSerial( String( F("NTP time sync completed. Time: ") ) + hourStr + ":" + minuteStr + ":" + secondStr + "." + timeValue.tv_usec / 1000, true );
@@ -1189,9 +1625,8 @@ void ntpProcessLoopTick() {
     initNtpClient();
   }
   if( isNtpClientInitialised ) {
-    unsigned long currentMillis = millis();
     #ifdef ESP8266
-    if( calculateDiffMillis( previousMillisNtpStatusCheck, currentMillis ) >= 10 ) {
+    {
       NTPClient::Status ntpStatus = timeClient.update();
 
       if( ntpStatus == NTPClient::STATUS_SUCCESS_RESPONSE ) {
@@ -1206,7 +1641,7 @@ void ntpProcessLoopTick() {
         isCustomDateTimeSet = false;
 
         String hourStr, minuteStr, secondStr;
-        calculateTimeToShow( hourStr, minuteStr, secondStr, isSingleDigitHourShown );
+        calculateTimeToShow( hourStr, minuteStr, secondStr, clockSettings.isSingleDigitHourShown );
         writeToSerial( String( F("NTP time sync completed. Time: ") ) + hourStr + ":" + minuteStr + ":" + secondStr + "." + timeClient.getSubSeconds(), true );
 
         forceDisplaySync();
@@ -1214,17 +1649,26 @@ void ntpProcessLoopTick() {
         timeClient.setUpdateInterval( DELAY_NTP_TIME_SYNC_RETRY );
         writeToSerial( F("NTP time sync error"), true );
       }
-      previousMillisNtpStatusCheck = currentMillis;
     }
     #else //ESP32 or ESP32S2
-    if( calculateDiffMillis( previousMillisNtpStatusCheck, currentMillis ) >= DELAY_NTP_TIME_SYNC + DELAY_NTP_TIME_SYNC_RETRY + DELAY_NTP_TIME_SYNC_AGGRESSIVE * 6 ) {
-      previousMillisNtpStatusCheck = previousMillisNtpStatusCheck + DELAY_NTP_TIME_SYNC_RETRY;
-      sntp_set_sync_interval( DELAY_NTP_TIME_SYNC_RETRY );
-    }
+
     #endif
   }
 }
 
+#ifdef ESP8266
+
+#else //ESP32 or ESP32S2
+void ntpStatusCheckProcessLoopTick() { //runs once there was no sync for DELAY_NTP_STATUS_CHECK, every sync pushes it back
+  if( !WiFi.isConnected() || !isNtpClientInitialised ) {
+    scheduler.rescheduleTask( ntpStatusCheckTaskId, DELAY_NTP_TIME_SYNC_AGGRESSIVE );
+    return;
+  }
+  sntp_set_sync_interval( DELAY_NTP_TIME_SYNC_RETRY );
+  scheduler.rescheduleTask( ntpStatusCheckTaskId, DELAY_NTP_TIME_SYNC_RETRY );
+}
+#endif
+
 
 //data update helpers
 void forceRefreshData() {
@@ -1249,129 +1693,482 @@ const String getWiFiStatusText( wl_status_t status ) {
     case WL_CONNECTION_LOST:
       return F("CONNECTION_LOST");
     #ifdef ESP8266
-    case WL_WRONG_PASSWORD:
-      return F("WRONG_PASSWORD");
+    case WL_WRONG_PASSWORD:
+      return F("WRONG_PASSWORD");
+    #endif
+    case WL_DISCONNECTED:
+      return F("DISCONNECTED");
+    default:
+      return F("Unknown");
+  }
+}
+
+void disconnectFromWiFi( bool turnWiFiModuleOff, bool erasePreviousCredentials ) { //does not wait for the status to change, the WiFi manager follows it
+  wl_status_t wifiStatus = WiFi.status();
+  if( wifiStatus == WL_NO_SHIELD ) return;
+  if( !turnWiFiModuleOff && ( wifiStatus == WL_DISCONNECTED || wifiStatus == WL_IDLE_STATUS ) ) return;
+  writeToSerial( String( F("Disconnecting from WiFi '") ) + WiFi.SSID() + String( F("'") ), true );
+  WiFi.disconnect( turnWiFiModuleOff, erasePreviousCredentials );
+}
+
+bool isRouterSsidProvided() {
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    if( strlen( wiFiCredentials[i].ssid ) != 0 ) return true;
+  }
+  return false;
+}
+
+String getFullWiFiHostName() {
+  String fullName = getWiFiHostName();
+  if( strlen(deviceName) > 0 ) {
+    fullName += " - ";
+    fullName += deviceName;
+  } else {
+  #ifdef ESP8266
+  fullName += " - " + String( ESP.getChipId() );
+  #else //ESP32 or ESP32S2
+  String macAddress = String( ESP.getEfuseMac() );
+  fullName += " - " + macAddress.substring( macAddress.length() - 4 );
+  #endif
+  }
+  size_t maxLen = sizeof(WiFiCredential::ssid) - 1;
+  if( fullName.length() > maxLen ) {
+    fullName = fullName.substring( 0, maxLen );
+  }
+  return fullName;
+}
+
+//wifi manager: WiFi events and the scheduler step the connection states, nothing waits for the radio
+const uint8_t WIFI_STATE_IDLE = 0; //connection is started on the next step
+const uint8_t WIFI_STATE_CONNECTING = 1;
+const uint8_t WIFI_STATE_CONNECTED = 2;
+const uint8_t WIFI_STATE_AP = 3; //access point fallback, router connection is retried after TIMEOUT_AP
+const uint8_t WIFI_STATE_RADIO_OFF = 4; //energy saving
+const uint8_t WIFI_STATE_SCANNING = 5; //looking for the known networks before connecting to them
+
+uint8_t wiFiState = WIFI_STATE_IDLE;
+unsigned long wiFiStateChangedMillis = 0;
+volatile bool isWiFiEventPending = false; //set by WiFi event callbacks, which may run outside of loop()
+
+String getWiFiStateText( uint8_t state ) {
+  switch( state ) {
+    case WIFI_STATE_IDLE:
+      return F("idle");
+    case WIFI_STATE_CONNECTING:
+      return F("connecting");
+    case WIFI_STATE_CONNECTED:
+      return F("connected");
+    case WIFI_STATE_AP:
+      return F("ap");
+    case WIFI_STATE_RADIO_OFF:
+      return F("off");
+    case WIFI_STATE_SCANNING:
+      return F("scanning");
+    default:
+      return F("unknown");
+  }
+}
+
+void setWiFiState( uint8_t state ) {
+  wiFiState = state;
+  wiFiStateChangedMillis = millis();
+}
+
+bool isWiFiShutdownRequired() {
+  return isEnergySavingMode && isRouterSsidProvided() && timeCanBeCalculated();
+}
+
+//wifi connection cache: the access point of the last successful connection is kept in RTC memory, which survives restarts and deep sleep, but not a power loss
+const uint32_t WIFI_CONNECTION_CACHE_MAGIC = 0x31434357; //"WCC1" in little endian
+const uint16_t TIMEOUT_CONNECT_WIFI_FAST = 5000; //directed connect to the cached access point, a full scan is done when it fails
+const bool IS_WIFI_IP_LEASE_REUSED = false; //skips DHCP by reusing the cached IP address; enable only when the router reserves the address for the clock
+
+struct WiFiConnectionCache {
+  uint32_t checksum; //covers the rest of the struct and the SSID of the credential used
+  uint32_t magic;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t credentialIndex;
+};
+static_assert( sizeof(WiFiConnectionCache) % 4 == 0, "RTC user memory is accessed in 4-byte blocks" );
+
+#ifdef ESP8266
+WiFiConnectionCache wiFiConnectionCache; //mirrors RTC user memory
+#else //ESP32 or ESP32S2
+RTC_NOINIT_ATTR WiFiConnectionCache wiFiConnectionCache; //RTC_DATA_ATTR would be reset on every boot other than a deep sleep wake
+#endif
+bool isWiFiConnectionCacheValid = false;
+bool isWiFiFastConnecting = false;
+bool isWiFiStaticIpApplied = false;
+unsigned long wiFiConnectStartedMillis = 0;
+unsigned long wiFiLastConnectMillis = 0; //time to connected of the last connection
+bool isWiFiLastConnectFast = false;
+
+uint32_t calculateWiFiConnectionCacheChecksum() { //FNV-1a
+  uint32_t hash = 2166136261UL;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>( &wiFiConnectionCache );
+  for( uint8_t i = sizeof(wiFiConnectionCache.checksum); i < sizeof(wiFiConnectionCache); i++ ) {
+    hash = ( hash ^ data[i] ) * 16777619UL;
+  }
+  if( wiFiConnectionCache.credentialIndex >= WIFI_CREDENTIALS_COUNT ) return ~hash;
+  const char* ssid = wiFiCredentials[wiFiConnectionCache.credentialIndex].ssid;
+  for( uint8_t i = 0; i < sizeof(wiFiCredentials[0].ssid) && ssid[i] != '\0'; i++ ) {
+    hash = ( hash ^ (uint8_t)ssid[i] ) * 16777619UL;
+  }
+  return hash;
+}
+
+void writeWiFiConnectionCache() {
+  #ifdef ESP8266
+  ESP.rtcUserMemoryWrite( 0, reinterpret_cast<uint32_t*>( &wiFiConnectionCache ), sizeof(wiFiConnectionCache) );
+  #endif
+}
+
+bool isPowerOnReset() { //RTC memory holds random data after a power loss
+  #ifdef ESP8266
+  return ESP.getResetInfoPtr()->reason == REASON_DEFAULT_RST;
+  #else //ESP32 or ESP32S2
+  esp_reset_reason_t resetReason = esp_reset_reason();
+  return resetReason == ESP_RST_POWERON || resetReason == ESP_RST_BROWNOUT;
+  #endif
+}
+
+void loadWiFiConnectionCache() {
+  #ifdef ESP8266
+  ESP.rtcUserMemoryRead( 0, reinterpret_cast<uint32_t*>( &wiFiConnectionCache ), sizeof(wiFiConnectionCache) );
+  #endif
+  isWiFiConnectionCacheValid = !isPowerOnReset() && wiFiConnectionCache.magic == WIFI_CONNECTION_CACHE_MAGIC && wiFiConnectionCache.credentialIndex < WIFI_CREDENTIALS_COUNT && wiFiConnectionCache.checksum == calculateWiFiConnectionCacheChecksum();
+  if( !isWiFiConnectionCacheValid ) {
+    wiFiConnectionCache.magic = 0;
+    writeWiFiConnectionCache();
+  }
+}
+
+void saveWiFiConnectionCache( uint8_t credentialIndex ) {
+  const uint8_t* bssid = WiFi.BSSID();
+  if( bssid == NULL ) return;
+  memcpy( wiFiConnectionCache.bssid, bssid, sizeof(wiFiConnectionCache.bssid) );
+  wiFiConnectionCache.channel = WiFi.channel();
+  wiFiConnectionCache.magic = WIFI_CONNECTION_CACHE_MAGIC;
+  wiFiConnectionCache.credentialIndex = credentialIndex;
+  wiFiConnectionCache.ip = (uint32_t)WiFi.localIP();
+  wiFiConnectionCache.gateway = (uint32_t)WiFi.gatewayIP();
+  wiFiConnectionCache.subnet = (uint32_t)WiFi.subnetMask();
+  wiFiConnectionCache.dns = (uint32_t)WiFi.dnsIP();
+  wiFiConnectionCache.checksum = calculateWiFiConnectionCacheChecksum();
+  writeWiFiConnectionCache();
+  isWiFiConnectionCacheValid = true;
+}
+
+void invalidateWiFiConnectionCache() {
+  if( !isWiFiConnectionCacheValid ) return;
+  wiFiConnectionCache.checksum = ~calculateWiFiConnectionCacheChecksum();
+  writeWiFiConnectionCache();
+  isWiFiConnectionCacheValid = false;
+}
+
+//wifi scan service: scans run in the background and their results are cached for the WiFi manager and the /scan page
+const uint8_t WIFI_SCAN_RESULTS_MAX = 16;
+const uint32_t DELAY_WIFI_SCAN_CACHE = 30000; //results younger than this are served instead of scanning again
+const uint16_t TIMEOUT_WIFI_SCAN = 10000;
+const uint16_t DELAY_WIFI_SCANNING_CHECK = 100;
+
+struct WiFiScanResult {
+  char ssid[32 + 1];
+  int8_t rssi;
+  uint8_t channel;
+  bool isEncrypted;
+};
+WiFiScanResult wiFiScanResults[WIFI_SCAN_RESULTS_MAX]; //strongest first, one entry per SSID
+uint8_t wiFiScanResultCount = 0;
+bool isWiFiScanRunning = false;
+bool isWiFiScanCached = false;
+unsigned long wiFiScanStartedMillis = 0;
+unsigned long wiFiScanCompletedMillis = 0;
+
+bool isWiFiScanFresh() {
+  return isWiFiScanCached && calculateDiffMillis( wiFiScanCompletedMillis, millis() ) < DELAY_WIFI_SCAN_CACHE;
+}
+
+void requestWiFiScan() {
+  if( isWiFiScanRunning ) return;
+  writeToSerial( F("Scanning WiFi networks..."), true );
+  WiFi.scanDelete();
+  WiFi.scanNetworks( true );
+  isWiFiScanRunning = true;
+  wiFiScanStartedMillis = millis();
+  scheduler.rescheduleTask( wiFiScanTaskId, DELAY_WIFI_SCANNING_CHECK );
+}
+
+void cacheWiFiScanResults( int16_t networkCount ) {
+  wiFiScanResultCount = 0;
+  for( int16_t networkIndex = 0; networkIndex < networkCount; networkIndex++ ) {
+    String ssid = WiFi.SSID( networkIndex );
+    if( ssid.length() == 0 || ssid.length() > sizeof(WiFiScanResult::ssid) - 1 ) continue; //hidden network
+    int32_t rssi = WiFi.RSSI( networkIndex );
+
+    uint8_t position = 0;
+    while( position < wiFiScanResultCount && ssid != wiFiScanResults[position].ssid ) position++;
+    if( position < wiFiScanResultCount ) { //another access point of the same network
+      if( wiFiScanResults[position].rssi >= rssi ) continue;
+      for( ; position + 1 < wiFiScanResultCount; position++ ) {
+        wiFiScanResults[position] = wiFiScanResults[position + 1];
+      }
+      wiFiScanResultCount--;
+    }
+
+    if( wiFiScanResultCount == WIFI_SCAN_RESULTS_MAX ) {
+      if( wiFiScanResults[WIFI_SCAN_RESULTS_MAX - 1].rssi >= rssi ) continue;
+      wiFiScanResultCount--; //the weakest network makes room
+    }
+    position = wiFiScanResultCount++;
+    while( position > 0 && wiFiScanResults[position - 1].rssi < rssi ) {
+      wiFiScanResults[position] = wiFiScanResults[position - 1];
+      position--;
+    }
+
+    WiFiScanResult& result = wiFiScanResults[position];
+    strncpy( result.ssid, ssid.c_str(), sizeof(result.ssid) );
+    result.rssi = rssi;
+    result.channel = WiFi.channel( networkIndex );
+    #ifdef ESP8266
+    result.isEncrypted = WiFi.encryptionType( networkIndex ) != ENC_TYPE_NONE;
+    #else //ESP32 or ESP32S2
+    result.isEncrypted = WiFi.encryptionType( networkIndex ) != WIFI_AUTH_OPEN;
     #endif
-    case WL_DISCONNECTED:
-      return F("DISCONNECTED");
-    default:
-      return F("Unknown");
   }
 }
 
-void disconnectFromWiFi( bool turnWiFiModuleOff, bool erasePreviousCredentials ) {
-  wl_status_t wifiStatus = WiFi.status();
-  if( wifiStatus != WL_DISCONNECTED && wifiStatus != WL_IDLE_STATUS && wifiStatus != WL_NO_SHIELD ) {
-    writeToSerial( String( F("Disconnecting from WiFi '") ) + WiFi.SSID() + String( F("'...") ), false );
-    uint8_t previousInternalLedStatus = getInternalLedStatus();
-    setInternalLedStatus( HIGH );
-    WiFi.disconnect( turnWiFiModuleOff, erasePreviousCredentials );
-    isWiFiRadioShutDown = turnWiFiModuleOff;
-    if( !turnWiFiModuleOff ) {
-      delay( 10 );
-      while( true ) {
-        wifiStatus = WiFi.status();
-        if( wifiStatus != WL_CONNECTED ) break;
-        delay( 50 );
-        writeToSerial( ".", false );
-      }
-    }
-    writeToSerial( F(" done"), true );
-    setInternalLedStatus( previousInternalLedStatus );
+void wiFiScanProcessLoopTick() {
+  if( !isWiFiScanRunning ) return;
+  int16_t networkCount = WiFi.scanComplete();
+  if( networkCount == WIFI_SCAN_RUNNING && calculateDiffMillis( wiFiScanStartedMillis, millis() ) < TIMEOUT_WIFI_SCAN ) {
+    scheduler.rescheduleTask( wiFiScanTaskId, DELAY_WIFI_SCANNING_CHECK );
+    return;
   }
-}
 
-bool isRouterSsidProvided() {
-  return strlen(wiFiClientSsid) != 0;
+  isWiFiScanRunning = false;
+  if( networkCount >= 0 ) {
+    cacheWiFiScanResults( networkCount );
+    isWiFiScanCached = true;
+    wiFiScanCompletedMillis = millis();
+    writeToSerial( String( F("WiFi scan found ") ) + String( wiFiScanResultCount ) + String( F(" networks") ), true );
+  } else {
+    writeToSerial( F("WiFi scan failed"), true );
+  }
+  WiFi.scanDelete();
+  isWiFiEventPending = true; //the WiFi manager may be waiting for the results
 }
 
-String getFullWiFiHostName() {
-  String fullName = getWiFiHostName();
-  if( strlen(deviceName) > 0 ) {
-    fullName += " - ";
-    fullName += deviceName;
-  } else {
-  #ifdef ESP8266
-  fullName += " - " + String( ESP.getChipId() );
-  #else //ESP32 or ESP32S2
-  String macAddress = String( ESP.getEfuseMac() );
-  fullName += " - " + macAddress.substring( macAddress.length() - 4 );
-  #endif
+//known networks: the cached scan ranks them, then they are tried one by one
+const uint8_t WIFI_SUCCESS_RANK_RSSI_PENALTY = 5; //each network connected more recently outweighs this many dB of signal strength
+
+uint8_t wiFiCandidates[WIFI_CREDENTIALS_COUNT]; //credential indexes in the order they are tried
+uint8_t wiFiCandidateCount = 0;
+uint8_t wiFiCandidatePosition = 0;
+uint8_t wiFiCredentialIndex = 0; //credential of the current connection attempt
+
+void promoteWiFiCredential( uint8_t credentialIndex ) { //makes the credential the most recently connected one
+  uint8_t previousRank = wiFiCredentials[credentialIndex].successRank;
+  if( previousRank == 0 ) return;
+  beginEepromTransaction();
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    if( wiFiCredentials[i].successRank < previousRank ) {
+      wiFiCredentials[i].successRank++;
+      writeEepromUint8Value( getEepromWiFiSuccessRankIndex( i ), wiFiCredentials[i].successRank );
+    }
   }
-  size_t maxLen = sizeof(wiFiClientSsid) - 1;
-  if( fullName.length() > maxLen ) {
-    fullName = fullName.substring( 0, maxLen );
+  wiFiCredentials[credentialIndex].successRank = 0;
+  writeEepromUint8Value( getEepromWiFiSuccessRankIndex( credentialIndex ), 0 );
+  commitEepromTransaction();
+}
+
+bool isWiFiCandidateBetter( uint8_t credentialIndex, uint8_t otherCredentialIndex, const bool* isVisible, const int32_t* rssi ) {
+  if( isVisible[credentialIndex] != isVisible[otherCredentialIndex] ) return isVisible[credentialIndex];
+  int32_t score = -WIFI_SUCCESS_RANK_RSSI_PENALTY * (int32_t)wiFiCredentials[credentialIndex].successRank;
+  int32_t otherScore = -WIFI_SUCCESS_RANK_RSSI_PENALTY * (int32_t)wiFiCredentials[otherCredentialIndex].successRank;
+  if( isVisible[credentialIndex] ) {
+    score += rssi[credentialIndex];
+    otherScore += rssi[otherCredentialIndex];
+  }
+  return score > otherScore;
+}
+
+void rankWiFiCandidates() { //networks that were not found are kept at the end, they may have a hidden SSID
+  bool isVisible[WIFI_CREDENTIALS_COUNT];
+  int32_t rssi[WIFI_CREDENTIALS_COUNT];
+  uint8_t networkCount = isWiFiScanFresh() ? wiFiScanResultCount : 0;
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    isVisible[i] = false;
+    rssi[i] = 0;
+    if( strlen( wiFiCredentials[i].ssid ) == 0 ) continue;
+    for( uint8_t networkIndex = 0; networkIndex < networkCount; networkIndex++ ) { //one entry per SSID
+      if( strcmp( wiFiScanResults[networkIndex].ssid, wiFiCredentials[i].ssid ) != 0 ) continue;
+      isVisible[i] = true;
+      rssi[i] = wiFiScanResults[networkIndex].rssi;
+      break;
+    }
+  }
+
+  wiFiCandidateCount = 0;
+  wiFiCandidatePosition = 0;
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    if( strlen( wiFiCredentials[i].ssid ) == 0 ) continue;
+    uint8_t position = wiFiCandidateCount++;
+    while( position > 0 && isWiFiCandidateBetter( i, wiFiCandidates[position - 1], isVisible, rssi ) ) {
+      wiFiCandidates[position] = wiFiCandidates[position - 1];
+      position--;
+    }
+    wiFiCandidates[position] = i;
+  }
+
+  for( uint8_t position = 0; position < wiFiCandidateCount; position++ ) {
+    uint8_t i = wiFiCandidates[position];
+    writeToSerial( String( F("WiFi candidate '") ) + String( wiFiCredentials[i].ssid ) + String( F("': ") ) + ( isVisible[i] ? String( rssi[i] ) + String( F(" dBm") ) : String( F("not found") ) ), true );
   }
-  return fullName;
 }
 
-void connectToWiFiAsync( bool isInit ) {
-  if( !isRouterSsidProvided() ) {
-    createAccessPoint();
-    return;
+void startWiFiScan() {
+  if( !isWiFiScanFresh() ) {
+    requestWiFiScan();
   }
+  setWiFiState( WIFI_STATE_SCANNING );
+}
 
-  writeToSerial( String( F("Connecting to WiFi '") ) + String( wiFiClientSsid ) + "'...", true );
-  WiFi.hostname( getFullWiFiHostName().c_str() );
-  WiFi.begin( wiFiClientSsid, wiFiClientPassword );
-  isWiFiRadioShutDown = false;
+void connectToWiFiCredential( uint8_t credentialIndex, bool isFastConnect ) {
+  wiFiCredentialIndex = credentialIndex;
+  isWiFiFastConnecting = isFastConnect;
+  const WiFiCredential& credential = wiFiCredentials[credentialIndex];
 
-  if( WiFi.isConnected() ) {
-    shutdownAccessPoint();
-    return;
+  if( isFastConnect && IS_WIFI_IP_LEASE_REUSED && wiFiConnectionCache.ip != 0 ) {
+    WiFi.config( IPAddress( wiFiConnectionCache.ip ), IPAddress( wiFiConnectionCache.gateway ), IPAddress( wiFiConnectionCache.subnet ), IPAddress( wiFiConnectionCache.dns ) );
+    isWiFiStaticIpApplied = true;
+  } else if( isWiFiStaticIpApplied ) { //back to DHCP
+    WiFi.config( IPAddress( 0, 0, 0, 0 ), IPAddress( 0, 0, 0, 0 ), IPAddress( 0, 0, 0, 0 ) );
+    isWiFiStaticIpApplied = false;
   }
 
-  wl_status_t wifiStatus = WiFi.status();
-  if( WiFi.isConnected() ) {
-    writeToSerial( String( F("WiFi is connected. Status: ") ) + getWiFiStatusText( wifiStatus ), true );
-    shutdownAccessPoint();
-    forceRefreshData();
-  } else if( !isInit && ( wifiStatus == WL_NO_SSID_AVAIL || wifiStatus == WL_CONNECT_FAILED || wifiStatus == WL_CONNECTION_LOST || wifiStatus == WL_IDLE_STATUS || wifiStatus == WL_DISCONNECTED ) ) {
-    writeToSerial( String( F("WiFi is NOT connected. Status: ") ) + getWiFiStatusText( wifiStatus ), true );
-    disconnectFromWiFi( false, false );
-    createAccessPoint();
+  if( isFastConnect ) {
+    writeToSerial( String( F("Connecting to WiFi '") ) + String( credential.ssid ) + String( F("' on cached channel ") ) + String( wiFiConnectionCache.channel ) + "...", true );
+    WiFi.begin( credential.ssid, credential.password, wiFiConnectionCache.channel, wiFiConnectionCache.bssid );
+  } else {
+    writeToSerial( String( F("Connecting to WiFi '") ) + String( credential.ssid ) + "'...", true );
+    WiFi.begin( credential.ssid, credential.password );
   }
+  setWiFiState( WIFI_STATE_CONNECTING );
 }
 
-
-void connectToWiFiSync() {
+void startWiFiConnection() {
   if( !isRouterSsidProvided() ) {
     createAccessPoint();
+    setWiFiState( WIFI_STATE_AP );
     return;
   }
 
-  writeToSerial( String( F("Connecting to WiFi '") ) + String( wiFiClientSsid ) + "'...", true );
   WiFi.hostname( getFullWiFiHostName().c_str() );
-  WiFi.begin( wiFiClientSsid, wiFiClientPassword );
-  isWiFiRadioShutDown = false;
+  wiFiConnectStartedMillis = millis();
+  if( isWiFiConnectionCacheValid ) {
+    connectToWiFiCredential( wiFiConnectionCache.credentialIndex, true );
+  } else {
+    startWiFiScan();
+  }
+}
 
-  if( WiFi.isConnected() ) {
-    shutdownAccessPoint();
-    return;
+void requestWiFiConnection() { //call after the router credentials change
+  invalidateWiFiConnectionCache();
+  shutdownAccessPoint();
+  setWiFiState( WIFI_STATE_IDLE );
+  scheduler.rescheduleTask( wiFiTaskId, 0 );
+}
+
+bool connectToNextWiFiCandidate() { //returns false when all candidates have been tried
+  if( wiFiCandidatePosition >= wiFiCandidateCount ) return false;
+  connectToWiFiCredential( wiFiCandidates[wiFiCandidatePosition++], false );
+  return true;
+}
+
+unsigned long fallbackToAccessPoint() {
+  disconnectFromWiFi( false, false );
+  createAccessPoint();
+  setWiFiState( WIFI_STATE_AP );
+  return TIMEOUT_AP;
+}
+
+unsigned long processWiFiState() { //returns the time until the state has to be checked again, WiFi events bring the check forward
+  if( isWiFiShutdownRequired() ) {
+    if( wiFiState != WIFI_STATE_RADIO_OFF ) {
+      shutdownAccessPoint();
+      disconnectFromWiFi( true, false );
+      setWiFiState( WIFI_STATE_RADIO_OFF );
+    }
+    return DELAY_WIFI_CONNECTION_CHECK;
   }
 
-  unsigned long wiFiConnectStartedMillis = millis();
-  uint8_t previousInternalLedStatus = getInternalLedStatus();
-  while( true ) {
-    setInternalLedStatus( HIGH );
-    delay( 250 );
-    wl_status_t wifiStatus = WiFi.status();
-    if( WiFi.isConnected() ) {
-      writeToSerial( F(" done"), true );
-      setInternalLedStatus( previousInternalLedStatus );
+  unsigned long currentMillis = millis();
+  switch( wiFiState ) {
+    case WIFI_STATE_IDLE:
+    case WIFI_STATE_RADIO_OFF:
+      startWiFiConnection();
+      return DELAY_WIFI_CONNECTING_CHECK;
+    case WIFI_STATE_SCANNING:
+      if( isWiFiScanRunning ) return TIMEOUT_WIFI_SCAN; //the scan service raises a WiFi event when it is done
+      rankWiFiCandidates();
+      if( !connectToNextWiFiCandidate() ) return fallbackToAccessPoint();
+      return DELAY_WIFI_CONNECTING_CHECK;
+    case WIFI_STATE_CONNECTING: {
+      if( WiFi.isConnected() ) {
+        wiFiLastConnectMillis = calculateDiffMillis( wiFiConnectStartedMillis, currentMillis );
+        isWiFiLastConnectFast = isWiFiFastConnecting;
+        writeToSerial( String( F("WiFi is connected in ") ) + String( wiFiLastConnectMillis ) + String( isWiFiLastConnectFast ? F(" ms using cached access point") : F(" ms") ), true );
+        setWiFiState( WIFI_STATE_CONNECTED );
+        promoteWiFiCredential( wiFiCredentialIndex );
+        saveWiFiConnectionCache( wiFiCredentialIndex );
+        shutdownAccessPoint();
+        forceRefreshData();
+        return DELAY_WIFI_CONNECTION_CHECK;
+      }
+      wl_status_t wifiStatus = WiFi.status();
+      bool isAttemptFailed = wifiStatus == WL_NO_SSID_AVAIL || wifiStatus == WL_CONNECT_FAILED;
+      if( isWiFiFastConnecting ) {
+        if( !isAttemptFailed && calculateDiffMillis( wiFiStateChangedMillis, currentMillis ) < TIMEOUT_CONNECT_WIFI_FAST ) return DELAY_WIFI_CONNECTING_CHECK;
+        writeToSerial( String( F("Cached access point is not available. Status: ") ) + getWiFiStatusText( wifiStatus ), true );
+        invalidateWiFiConnectionCache();
+        WiFi.disconnect(); //the radio does not scan while it is still trying to join
+        startWiFiScan();
+        return 0;
+      }
+      if( !isAttemptFailed && calculateDiffMillis( wiFiStateChangedMillis, currentMillis ) < TIMEOUT_CONNECT_WIFI ) return DELAY_WIFI_CONNECTING_CHECK;
+      writeToSerial( String( F("WiFi '") ) + String( wiFiCredentials[wiFiCredentialIndex].ssid ) + String( F("' is NOT connected. Status: ") ) + getWiFiStatusText( wifiStatus ), true );
+      if( connectToNextWiFiCandidate() ) return DELAY_WIFI_CONNECTING_CHECK;
+      return fallbackToAccessPoint();
+    }
+    case WIFI_STATE_CONNECTED:
+      if( WiFi.isConnected() ) return DELAY_WIFI_CONNECTION_CHECK;
+      writeToSerial( String( F("WiFi connection lost. Status: ") ) + getWiFiStatusText( WiFi.status() ), true );
+      startWiFiConnection();
+      return DELAY_WIFI_CONNECTING_CHECK;
+    case WIFI_STATE_AP: {
+      if( !isRouterSsidProvided() ) return TIMEOUT_AP; //stays until the credentials are saved
+      unsigned long apMillis = calculateDiffMillis( apStartedMillis, currentMillis ); //page loads in AP mode restart the timeout
+      if( apMillis < TIMEOUT_AP ) return TIMEOUT_AP - apMillis;
       shutdownAccessPoint();
-      forceRefreshData();
-      break;
-    } else if( ( wifiStatus == WL_NO_SSID_AVAIL || wifiStatus == WL_CONNECT_FAILED || wifiStatus == WL_CONNECTION_LOST || wifiStatus == WL_IDLE_STATUS ) && ( calculateDiffMillis( wiFiConnectStartedMillis, millis() ) >= TIMEOUT_CONNECT_WIFI_SYNC ) ) {
-      writeToSerial( String( F(" ERROR: ") ) + getWiFiStatusText( wifiStatus ), true );
-      setInternalLedStatus( previousInternalLedStatus );
-      disconnectFromWiFi( false, false );
-      createAccessPoint();
-      break;
+      startWiFiConnection();
+      return DELAY_WIFI_CONNECTING_CHECK;
     }
+    default:
+      return DELAY_WIFI_CONNECTION_CHECK;
   }
 }
 
+void wiFiProcessLoopTick() {
+  isWiFiEventPending = false;
+  scheduler.rescheduleTask( wiFiTaskId, processWiFiState() );
+}
+
 
 //web server
 const char HTML_PAGE_START[] PROGMEM = "<!DOCTYPE html>"
@@ -1529,24 +2326,18 @@ String getHtmlInput( String label, const char* type, const char* value, const ch
       ( (strcmp(type, HTML_INPUT_TEXT) != 0 && strcmp(type, HTML_INPUT_PASSWORD) != 0 && strcmp(type, HTML_INPUT_COLOR) != 0 && strcmp(type, HTML_INPUT_RANGE) != 0) ? getHtmlLabel( label, elId, false ) : "" );
 }
 
-const char* HTML_PAGE_WIFI_SSID_NAME = "ssid";
-const char* HTML_PAGE_WIFI_PWD_NAME = "pwd";
-
-const char* HTML_PAGE_FONT_TYPE_NAME = "fnt";
-const char* HTML_PAGE_BOLD_FONT_NAME = "bld";
-const char* HTML_PAGE_SHOW_SECS_NAME = "sec";
-const char* HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME = "sdh";
-const char* HTML_PAGE_COMPACT_LAYOUT_NAME = "cl";
-const char* HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME = "ssa";
-const char* HTML_PAGE_ROTATE_DISPLAY_NAME = "rot";
-const char* HTML_PAGE_CLOCK_ANIMATED_NAME = "ca";
-const char* HTML_PAGE_ANIMATION_TYPE_NAME = "at";
-const char* HTML_PAGE_BRIGHTNESS_DAY_NAME = "brtd";
-const char* HTML_PAGE_BRIGHTNESS_NIGHT_NAME = "brtn";
-const char* HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME = "brsd";
-const char* HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME = "brsn";
-const char* HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME = "brst";
-const char* HTML_PAGE_DEVICE_NAME_NAME = "dvn";
+String getWiFiCredentialsHtml() {
+  String content;
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    const WiFiCredential& credential = wiFiCredentials[i];
+    String ssidElName = String( HTML_PAGE_WIFI_SSID_NAME ) + String( i );
+    String pwdElName = String( HTML_PAGE_WIFI_PWD_NAME ) + String( i );
+    content += String( F("<div class=\"fi\">") ) + getHtmlInput( String( F("SSID назва #") ) + String( i + 1 ), HTML_INPUT_TEXT, credential.ssid, ssidElName.c_str(), ssidElName.c_str(), 0, sizeof(credential.ssid) - 1, 0, false, false, "list=\"wfl\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( String( F("SSID пароль #") ) + String( i + 1 ), HTML_INPUT_PASSWORD, credential.password, pwdElName.c_str(), pwdElName.c_str(), 0, sizeof(credential.password) - 1, 0, false, false, "", "" ) + String( F("</div>") );
+  }
+  content += String( F("<datalist id=\"wfl\"></datalist>") ); //filled with the networks in reach by scan()
+  return content;
+}
 
 void handleWebServerGet() {
   wifiWebServer.setContentLength( CONTENT_LENGTH_UNKNOWN );
@@ -1588,6 +2379,7 @@ void handleWebServerGet() {
       "document.getElementById('title').textContent+=' - '+devnm;"
     "}"
     "dt();"
+    "scan();"
     "pv();"
     "mnf(true);"
     "graph.draw(true);"
@@ -1598,6 +2390,21 @@ void handleWebServerGet() {
     "fetch('/setdt?t='+Date.now().toString()).catch(e=>{"
     "});"
   "}"
+  "function scan(){"
+    "fetch('/scan').then(res=>{"
+      "return res.json();"
+    "}).then(sc=>{"
+      "let wfl=document.getElementById('wfl');"
+      "wfl.replaceChildren(...sc.networks.map(n=>{"
+        "let o=document.createElement('option');"
+        "o.value=n.ssid;"
+        "o.label=n.rssi+' dBm'+(n.enc?'':' (open)');"
+        "return o;"
+      "}));"
+      "if(sc.scanning)setTimeout(scan,2000);"
+    "}).catch(e=>{"
+    "});"
+  "}"
   "let pvTimer=null;"
   "let pvAbort=null;"
   "function pv(){"
@@ -1840,9 +2647,7 @@ void handleWebServerGet() {
     "<div class=\"fxh\">"
       "Приєднатись до WiFi"
     "</div>"
-    "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("SSID назва"), HTML_INPUT_TEXT, wiFiClientSsid, HTML_PAGE_WIFI_SSID_NAME, HTML_PAGE_WIFI_SSID_NAME, 0, sizeof(wiFiClientSsid) - 1, 0, false, false, "", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("SSID пароль"), HTML_INPUT_PASSWORD, wiFiClientPassword, HTML_PAGE_WIFI_PWD_NAME, HTML_PAGE_WIFI_PWD_NAME, 0, sizeof(wiFiClientPassword) - 1, 0, false, false, "", "" ) + String( F("</div>"
+    "<div class=\"fxc\">") ) + getWiFiCredentialsHtml() + String( F(""
     "</div>"
   "</div>"
   "<div class=\"fx fxsect\">"
@@ -1858,10 +2663,10 @@ void handleWebServerGet() {
       "Вигляд"
     "</div>"
     "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Показувати секунди"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SHOW_SECS_NAME, HTML_PAGE_SHOW_SECS_NAME, 0, 0, 0, false, isDisplaySecondsShown, "onchange=\"pv();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Показувати час без переднього нуля"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME, HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME, 0, 0, 0, false, isSingleDigitHourShown, "onchange=\"pv();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Зменшити відстань до двокрапок"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_COMPACT_LAYOUT_NAME, HTML_PAGE_COMPACT_LAYOUT_NAME, 0, 0, 0, false, isDisplayCompactLayoutUsed, "onchange=\"pv();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Повільні двокрапки (30 разів в хв)"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME, HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME, 0, 0, 0, false, isSlowSemicolonAnimation, "", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Показувати секунди"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SHOW_SECS_NAME, HTML_PAGE_SHOW_SECS_NAME, 0, 0, 0, false, clockSettings.isDisplaySecondsShown, "onchange=\"pv();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Показувати час без переднього нуля"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME, HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME, 0, 0, 0, false, clockSettings.isSingleDigitHourShown, "onchange=\"pv();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Зменшити відстань до двокрапок"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_COMPACT_LAYOUT_NAME, HTML_PAGE_COMPACT_LAYOUT_NAME, 0, 0, 0, false, clockSettings.isDisplayCompactLayoutUsed, "onchange=\"pv();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Повільні двокрапки (30 разів в хв)"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME, HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME, 0, 0, 0, false, clockSettings.isSlowSemicolonAnimation, "", "" ) + String( F("</div>"
     "</div>"
   "</div>"
   "<div class=\"fx fxsect\">"
@@ -1869,8 +2674,8 @@ void handleWebServerGet() {
       "Шрифт"
     "</div>"
     "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Вид шрифта"), HTML_INPUT_RANGE, String(displayFontTypeNumber).c_str(), HTML_PAGE_FONT_TYPE_NAME, HTML_PAGE_FONT_TYPE_NAME, 1, TCFonts::NUMBER_OF_FONTS_SUPPORTED, 0, false, displayFontTypeNumber, "onchange=\"pv();\"", "" ) + String( F("<span class=\"pl\"><a href=\"/fontedit\">Редактор</a></span></div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Жирний шрифт"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_BOLD_FONT_NAME, HTML_PAGE_BOLD_FONT_NAME, 0, 0, 0, false, isDisplayBoldFontUsed, "onchange=\"pv();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Вид шрифта"), HTML_INPUT_RANGE, String(clockSettings.displayFontTypeNumber).c_str(), HTML_PAGE_FONT_TYPE_NAME, HTML_PAGE_FONT_TYPE_NAME, 1, TCFonts::NUMBER_OF_FONTS_SUPPORTED, 0, false, clockSettings.displayFontTypeNumber, "onchange=\"pv();\"", "" ) + String( F("<span class=\"pl\"><a href=\"/fontedit\">Редактор</a></span></div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Жирний шрифт"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_BOLD_FONT_NAME, HTML_PAGE_BOLD_FONT_NAME, 0, 0, 0, false, clockSettings.isDisplayBoldFontUsed, "onchange=\"pv();\"", "" ) + String( F("</div>"
     "</div>"
   "</div>"
   "<div class=\"fx fxsect\">"
@@ -1878,8 +2683,8 @@ void handleWebServerGet() {
       "Анімація"
     "</div>"
     "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Анімований годинник"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_CLOCK_ANIMATED_NAME, HTML_PAGE_CLOCK_ANIMATED_NAME, 0, 0, 0, false, isClockAnimated, "", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Вид анімації"), HTML_INPUT_RANGE, String(animationTypeNumber).c_str(), HTML_PAGE_ANIMATION_TYPE_NAME, HTML_PAGE_ANIMATION_TYPE_NAME, 1, TCData::NUMBER_OF_ANIMATIONS_SUPPORTED, 0, false, false, "", String( F( "oninput=\"this.nextElementSibling.src='/data?p='+this.value;\"><img class=\"ap\" src=\"/data?p=" ) ) + String( animationTypeNumber ) + String( F( "\"" ) ) ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Анімований годинник"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_CLOCK_ANIMATED_NAME, HTML_PAGE_CLOCK_ANIMATED_NAME, 0, 0, 0, false, clockSettings.isClockAnimated, "", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Вид анімації"), HTML_INPUT_RANGE, String(clockSettings.animationTypeNumber).c_str(), HTML_PAGE_ANIMATION_TYPE_NAME, HTML_PAGE_ANIMATION_TYPE_NAME, 1, TCAnimations::getAnimationCount(), 0, false, false, "", String( F( "oninput=\"this.nextElementSibling.src='/data?p='+this.value;\"><img class=\"ap\" src=\"/data?p=" ) ) + String( clockSettings.animationTypeNumber ) + String( F( "\"" ) ) ) + String( F("</div>"
     "</div>"
   "</div>"
   "<div class=\"fx fxsect\">"
@@ -1887,11 +2692,11 @@ void handleWebServerGet() {
       "Яскравість"
     "</div>"
     "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Яскравість вдень"), HTML_INPUT_RANGE, String(displayDayBrightness).c_str(), HTML_PAGE_BRIGHTNESS_DAY_NAME, HTML_PAGE_BRIGHTNESS_DAY_NAME, 0, 15, 0, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Яскравість вночі"), HTML_INPUT_RANGE, String(displayNightBrightness).c_str(), HTML_PAGE_BRIGHTNESS_NIGHT_NAME, HTML_PAGE_BRIGHTNESS_NIGHT_NAME, 0, 15, 0, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Сенсор яскравості (день)"), HTML_INPUT_RANGE, String(sensorBrightnessDayLevel).c_str(), HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME, HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME, 0, ADC_NUMBER_OF_VALUES - 1, 1, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Сенсор яскравості (ніч)"), HTML_INPUT_RANGE, String(sensorBrightnessNightLevel).c_str(), HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME, HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME, 0, ADC_NUMBER_OF_VALUES - 1, 1, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Крутизна залежності"), HTML_INPUT_RANGE, String(brightnessSteepnessCoefficient).c_str(), HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME, HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME, 0, 255, 1, false, false, "onchange=\"graph.draw();\"", String( F( "oninput=\"this.nextElementSibling.value=(this.value*" ) ) + String(brightnessSteepnessCoefficientStep) + String( F( ").toFixed(2);\"><output>" ) ) + String(brightnessSteepnessCoefficient*brightnessSteepnessCoefficientStep).c_str() + String( F( "</output" ) ) ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Яскравість вдень"), HTML_INPUT_RANGE, String(clockSettings.displayDayBrightness).c_str(), HTML_PAGE_BRIGHTNESS_DAY_NAME, HTML_PAGE_BRIGHTNESS_DAY_NAME, 0, 15, 0, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Яскравість вночі"), HTML_INPUT_RANGE, String(clockSettings.displayNightBrightness).c_str(), HTML_PAGE_BRIGHTNESS_NIGHT_NAME, HTML_PAGE_BRIGHTNESS_NIGHT_NAME, 0, 15, 0, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Сенсор яскравості (день)"), HTML_INPUT_RANGE, String(clockSettings.sensorBrightnessDayLevel).c_str(), HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME, HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME, 0, ADC_NUMBER_OF_VALUES - 1, 1, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Сенсор яскравості (ніч)"), HTML_INPUT_RANGE, String(clockSettings.sensorBrightnessNightLevel).c_str(), HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME, HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME, 0, ADC_NUMBER_OF_VALUES - 1, 1, false, false, "onchange=\"graph.draw();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Крутизна залежності"), HTML_INPUT_RANGE, String(clockSettings.brightnessSteepnessCoefficient).c_str(), HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME, HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME, 0, 255, 1, false, false, "onchange=\"graph.draw();\"", String( F( "oninput=\"this.nextElementSibling.value=(this.value*" ) ) + String(brightnessSteepnessCoefficientStep) + String( F( ").toFixed(2);\"><output>" ) ) + String(clockSettings.brightnessSteepnessCoefficient*brightnessSteepnessCoefficientStep).c_str() + String( F( "</output" ) ) ) + String( F("</div>"
       "<div class=\"fi fv\">"
         "<div class=\"fi ex\"><div class=\"ex ext extfwon\" onclick=\"ex(this);mnt(2);\">Графік (сенсор &rarr; яскравість)</div></div>"
         "<div class=\"fi ex exc\"><div class=\"fi\"><div id=\"gc\"><div id=\"gw\"><div id=\"gr\"></div><div id=\"yg\"></div><div id=\"xg\"></div></div></div></div></div>"
@@ -1903,7 +2708,7 @@ void handleWebServerGet() {
       "Інші налаштування"
     "</div>"
     "<div class=\"fxc\">"
-      "<div class=\"fi\">") ) + getHtmlInput( F("Розвернути зображення на 180°"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_ROTATE_DISPLAY_NAME, HTML_PAGE_ROTATE_DISPLAY_NAME, 0, 0, 0, false, isRotateDisplay, "onchange=\"rt();\"", "" ) + String( F("</div>"
+      "<div class=\"fi\">") ) + getHtmlInput( F("Розвернути зображення на 180°"), HTML_INPUT_CHECKBOX, "", HTML_PAGE_ROTATE_DISPLAY_NAME, HTML_PAGE_ROTATE_DISPLAY_NAME, 0, 0, 0, false, clockSettings.isRotateDisplay, "onchange=\"rt();\"", "" ) + String( F("</div>"
       "<div class=\"fi\">") ) + getHtmlInput( F("Назва пристрою"), HTML_INPUT_TEXT, deviceName, HTML_PAGE_DEVICE_NAME_NAME, HTML_PAGE_DEVICE_NAME_NAME, 0, sizeof(deviceName) - 1, 0, false, false, "oninput=\"sanitize(this);\"", "" ) + String( F("</div>"
     "</div>"
   "</div>"
@@ -1990,282 +2795,102 @@ String getHtmlPageFillup( String animationLength, String redirectLength ) {
 bool isDisplayIntensityUpdateRequiredAfterSettingChanged = false;
 bool isDisplayRerenderRequiredAfterSettingChanged = false;
 
-void handleWebServerPost() {
-  String content;
-
-  String htmlPageSsidNameReceived = wifiWebServer.arg( HTML_PAGE_WIFI_SSID_NAME );
-  String htmlPageSsidPasswordReceived = wifiWebServer.arg( HTML_PAGE_WIFI_PWD_NAME );
-
-  if( htmlPageSsidNameReceived.length() == 0 ) {
-    htmlPageSsidNameReceived = "";
-    htmlPageSsidPasswordReceived = "";
-  }
-  if( htmlPageSsidNameReceived.length() > sizeof(wiFiClientSsid) - 1 ) {
-    addHtmlPageStart( content );
-    content += String( F("<h2>Error: SSID Name exceeds maximum length of ") ) + String( sizeof(wiFiClientSsid) - 1 ) + String( F("</h2>") );
-    addHtmlPageEnd( content );
-    wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
-    wifiWebServer.send( 400, getContentType( F("html") ), content );
-    return;
-  }
-  if( htmlPageSsidPasswordReceived.length() > sizeof(wiFiClientPassword) - 1 ) {
-    addHtmlPageStart( content );
-    content += String( F("<h2>Error: SSID Password exceeds maximum length of ") ) + String( sizeof(wiFiClientPassword) - 1 ) + String( F("</h2>") );
-    addHtmlPageEnd( content );
-    wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
-    wifiWebServer.send( 400, getContentType( F("html") ), content );
-    return;
+bool containsOnlyDigits( const String &str ) {
+  size_t length = str.length();
+  for( size_t i = 0; i < length; ++i ) {
+    if( isdigit( str.charAt(i) ) ) continue;
+    return false;
   }
+  return true;
+}
 
+void handleWebServerPost() {
+  String content;
 
-  String htmlPageIsSingleDigitHourShownReceived = wifiWebServer.arg( HTML_PAGE_SHOW_SINGLE_DIGIT_HOUR_NAME );
-  bool isSingleDigitHourShownReceived = false;
-  bool isSingleDigitHourShownReceivedPopulated = false;
-  if( htmlPageIsSingleDigitHourShownReceived == "on" ) {
-    isSingleDigitHourShownReceived = true;
-    isSingleDigitHourShownReceivedPopulated = true;
-  } else if( htmlPageIsSingleDigitHourShownReceived == "" ) {
-    isSingleDigitHourShownReceived = false;
-    isSingleDigitHourShownReceivedPopulated = true;
-  }
-
-  String htmlPageIsCompactLayoutReceived = wifiWebServer.arg( HTML_PAGE_COMPACT_LAYOUT_NAME );
-  bool isCompactLayoutReceived = false;
-  bool isCompactLayoutReceivedPopulated = false;
-  if( htmlPageIsCompactLayoutReceived == "on" ) {
-    isCompactLayoutReceived = true;
-    isCompactLayoutReceivedPopulated = true;
-  } else if( htmlPageIsCompactLayoutReceived == "" ) {
-    isCompactLayoutReceived = false;
-    isCompactLayoutReceivedPopulated = true;
-  }
-
-  String htmlPageIsClockAnimatedReceived = wifiWebServer.arg( HTML_PAGE_CLOCK_ANIMATED_NAME );
-  bool isClockAnimatedReceived = false;
-  bool isClockAnimatedReceivedPopulated = false;
-  if( htmlPageIsClockAnimatedReceived == "on" ) {
-    isClockAnimatedReceived = true;
-    isClockAnimatedReceivedPopulated = true;
-  } else if( htmlPageIsClockAnimatedReceived == "" ) {
-    isClockAnimatedReceived = false;
-    isClockAnimatedReceivedPopulated = true;
-  }
-
-
-  String htmlPageDisplayFontTypeNumberReceived = wifiWebServer.arg( HTML_PAGE_FONT_TYPE_NAME );
-  uint displayFontTypeNumberReceived = htmlPageDisplayFontTypeNumberReceived.toInt();
-  bool displayFontTypeNumberReceivedPopulated = false;
-  if( displayFontTypeNumberReceived > 0 && displayFontTypeNumberReceived <= (uint)TCFonts::NUMBER_OF_FONTS_SUPPORTED ) {
-    displayFontTypeNumberReceivedPopulated = true;
-  }
-
-  String htmlPageIsDisplayBoldFondUsedReceived = wifiWebServer.arg( HTML_PAGE_BOLD_FONT_NAME );
-  bool isDisplayBoldFondUsedReceived = false;
-  bool isDisplayBoldFondUsedReceivedPopulated = false;
-  if( htmlPageIsDisplayBoldFondUsedReceived == "on" ) {
-    isDisplayBoldFondUsedReceived = true;
-    isDisplayBoldFondUsedReceivedPopulated = true;
-  } else if( htmlPageIsDisplayBoldFondUsedReceived == "" ) {
-    isDisplayBoldFondUsedReceived = false;
-    isDisplayBoldFondUsedReceivedPopulated = true;
-  }
-
-  String htmlPageIsDisplaySecondsShownReceived = wifiWebServer.arg( HTML_PAGE_SHOW_SECS_NAME );
-  bool isDisplaySecondsShownReceived = false;
-  bool isDisplaySecondsShownReceivedPopulated = false;
-  if( htmlPageIsDisplaySecondsShownReceived == "on" ) {
-    isDisplaySecondsShownReceived = true;
-    isDisplaySecondsShownReceivedPopulated = true;
-  } else if( htmlPageIsDisplaySecondsShownReceived == "" ) {
-    isDisplaySecondsShownReceived = false;
-    isDisplaySecondsShownReceivedPopulated = true;
-  }
-
-  String htmlPageIsRotateDisplayReceived = wifiWebServer.arg( HTML_PAGE_ROTATE_DISPLAY_NAME );
-  bool isRotateDisplayReceived = false;
-  bool isRotateDisplayReceivedPopulated = false;
-  if( htmlPageIsRotateDisplayReceived == "on" ) {
-    isRotateDisplayReceived = true;
-    isRotateDisplayReceivedPopulated = true;
-  } else if( htmlPageIsRotateDisplayReceived == "" ) {
-    isRotateDisplayReceived = false;
-    isRotateDisplayReceivedPopulated = true;
-  }
-
-  String htmlPageAnimationTypeNumberReceived = wifiWebServer.arg( HTML_PAGE_ANIMATION_TYPE_NAME );
-  uint animationTypeNumberReceived = htmlPageAnimationTypeNumberReceived.toInt();
-  bool animationTypeNumberReceivedPopulated = false;
-  if( animationTypeNumberReceived > 0 && animationTypeNumberReceived <= (uint)TCData::NUMBER_OF_ANIMATIONS_SUPPORTED ) {
-    animationTypeNumberReceivedPopulated = true;
-  }
-
-  String htmlPageIsSlowSemicolonAnimationReceived = wifiWebServer.arg( HTML_PAGE_SLOW_SEMICOLON_ANIMATION_NAME );
-  bool isSlowSemicolonAnimationReceived = false;
-  bool isSlowSemicolonAnimationReceivedPopulated = false;
-  if( htmlPageIsSlowSemicolonAnimationReceived == "on" ) {
-    isSlowSemicolonAnimationReceived = true;
-    isSlowSemicolonAnimationReceivedPopulated = true;
-  } else if( htmlPageIsSlowSemicolonAnimationReceived == "" ) {
-    isSlowSemicolonAnimationReceived = false;
-    isSlowSemicolonAnimationReceivedPopulated = true;
-  }
-
-  String htmlPageDisplayDayBrightnessReceived = wifiWebServer.arg( HTML_PAGE_BRIGHTNESS_DAY_NAME );
-  uint displayDayBrightnessReceived = htmlPageDisplayDayBrightnessReceived.toInt();
-  bool displayDayBrightnessReceivedPopulated = false;
-  if( displayDayBrightnessReceived >= 0 && displayDayBrightnessReceived <= 15 ) {
-    displayDayBrightnessReceivedPopulated = true;
-  }
-
-  String htmlPageDisplayNightBrightnessReceived = wifiWebServer.arg( HTML_PAGE_BRIGHTNESS_NIGHT_NAME );
-  uint displayNightBrightnessReceived = htmlPageDisplayNightBrightnessReceived.toInt();
-  bool displayNightBrightnessReceivedPopulated = false;
-  if( displayNightBrightnessReceived >= 0 && displayNightBrightnessReceived <= 15 ) {
-    displayNightBrightnessReceivedPopulated = true;
-    if( displayNightBrightnessReceived > displayDayBrightnessReceived ) {
-      displayNightBrightnessReceived = displayDayBrightnessReceived;
+  String htmlPageSsidNamesReceived[WIFI_CREDENTIALS_COUNT];
+  String htmlPageSsidPasswordsReceived[WIFI_CREDENTIALS_COUNT];
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    String& htmlPageSsidNameReceived = htmlPageSsidNamesReceived[i];
+    String& htmlPageSsidPasswordReceived = htmlPageSsidPasswordsReceived[i];
+    htmlPageSsidNameReceived = wifiWebServer.arg( String( HTML_PAGE_WIFI_SSID_NAME ) + String( i ) );
+    htmlPageSsidPasswordReceived = wifiWebServer.arg( String( HTML_PAGE_WIFI_PWD_NAME ) + String( i ) );
+
+    if( htmlPageSsidNameReceived.length() == 0 ) {
+      htmlPageSsidNameReceived = "";
+      htmlPageSsidPasswordReceived = "";
+    }
+    if( htmlPageSsidNameReceived.length() > sizeof(WiFiCredential::ssid) - 1 ) {
+      addHtmlPageStart( content );
+      content += String( F("<h2>Error: SSID Name exceeds maximum length of ") ) + String( sizeof(WiFiCredential::ssid) - 1 ) + String( F("</h2>") );
+      addHtmlPageEnd( content );
+      wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
+      wifiWebServer.send( 400, getContentType( F("html") ), content );
+      return;
+    }
+    if( htmlPageSsidPasswordReceived.length() > sizeof(WiFiCredential::password) - 1 ) {
+      addHtmlPageStart( content );
+      content += String( F("<h2>Error: SSID Password exceeds maximum length of ") ) + String( sizeof(WiFiCredential::password) - 1 ) + String( F("</h2>") );
+      addHtmlPageEnd( content );
+      wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
+      wifiWebServer.send( 400, getContentType( F("html") ), content );
+      return;
     }
   }
 
-  String htmlPageSensorBrightnessDayReceived = wifiWebServer.arg( HTML_PAGE_BRIGHTNESS_DAY_SENSOR_NAME );
-  uint sensorBrightnessDayReceived = htmlPageSensorBrightnessDayReceived.toInt();
-  bool sensorBrightnessDayReceivedPopulated = false;
-  if( sensorBrightnessDayReceived >= 0 && sensorBrightnessDayReceived <= ADC_NUMBER_OF_VALUES - 1 ) {
-    sensorBrightnessDayReceivedPopulated = true;
-  }
 
-  String htmlPageSensorBrightnessNightReceived = wifiWebServer.arg( HTML_PAGE_BRIGHTNESS_NIGHT_SENSOR_NAME );
-  uint sensorBrightnessNightReceived = htmlPageSensorBrightnessNightReceived.toInt();
-  bool sensorBrightnessNightReceivedPopulated = false;
-  if( sensorBrightnessNightReceived >= 0 && sensorBrightnessNightReceived <= ADC_NUMBER_OF_VALUES - 1 ) {
-    sensorBrightnessNightReceivedPopulated = true;
-    if( sensorBrightnessNightReceived > sensorBrightnessDayReceived ) {
-      sensorBrightnessNightReceived = sensorBrightnessDayReceived;
+  ClockSettings clockSettingsReceived = clockSettings; //all the settings are parsed and validated together before any of them is applied
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    const ClockSettingDescriptor& setting = CLOCK_SETTINGS[i];
+    String htmlPageValueReceived = wifiWebServer.arg( setting.name );
+    if( setting.type == CLOCK_SETTING_BOOL ) { //an unchecked checkbox is not sent at all
+      if( htmlPageValueReceived == "on" || htmlPageValueReceived == "" ) {
+        setClockSettingValue( clockSettingsReceived, setting, htmlPageValueReceived == "on" );
+      }
+    } else if( htmlPageValueReceived.length() > 0 && htmlPageValueReceived.length() <= 5 && containsOnlyDigits( htmlPageValueReceived ) ) {
+      long valueReceived = htmlPageValueReceived.toInt();
+      if( isClockSettingValueValid( setting, valueReceived ) ) {
+        setClockSettingValue( clockSettingsReceived, setting, valueReceived );
+      }
     }
   }
-
-  String htmlPageSensorBrightnessSteepnessReceived = wifiWebServer.arg( HTML_PAGE_BRIGHTNESS_STEEPNESS_NAME );
-  uint sensorBrightnessSteepnessReceived = htmlPageSensorBrightnessSteepnessReceived.toInt();
-  bool sensorBrightnessSteepnessReceivedPopulated = false;
-  if( sensorBrightnessSteepnessReceived >= 0 && sensorBrightnessSteepnessReceived <= 255 ) {
-    sensorBrightnessSteepnessReceivedPopulated = true;
-  }
+  validateClockSettings( clockSettingsReceived );
 
   char sanitizedDeviceNameReceived[sizeof(deviceName)];
   String htmlPageDeviceNameReceived = wifiWebServer.arg( HTML_PAGE_DEVICE_NAME_NAME );
   sanitizeTextAscii( htmlPageDeviceNameReceived, sanitizedDeviceNameReceived, sizeof(deviceName) - 1 );
 
 
-  bool isWiFiChanged = strcmp( wiFiClientSsid, htmlPageSsidNameReceived.c_str() ) != 0 || strcmp( wiFiClientPassword, htmlPageSsidPasswordReceived.c_str() ) != 0;
+  bool isWiFiChanged = false;
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    isWiFiChanged = isWiFiChanged || strcmp( wiFiCredentials[i].ssid, htmlPageSsidNamesReceived[i].c_str() ) != 0 || strcmp( wiFiCredentials[i].password, htmlPageSsidPasswordsReceived[i].c_str() ) != 0;
+  }
 
-  String waitTime = isWiFiChanged ? String(TIMEOUT_CONNECT_WIFI_SYNC/1000 + 6) : "2";
+  String waitTime = isWiFiChanged ? String(TIMEOUT_CONNECT_WIFI/1000 + 6) : "2";
   addHtmlPageStart( content );
   content += getHtmlPageFillup( waitTime, waitTime ) + String( F("<h2>Зберігаю...</h2>") );
   addHtmlPageEnd( content );
   wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
   wifiWebServer.send( 200, getContentType( F("html") ), content );
 
-  if( isSingleDigitHourShownReceivedPopulated && isSingleDigitHourShownReceived != isSingleDigitHourShown ) {
-    isSingleDigitHourShown = isSingleDigitHourShownReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Show single digit hour updated"), true );
-    writeEepromBoolValue( eepromIsSingleDigitHourShownIndex, isSingleDigitHourShownReceived );
-  }
-
-  if( isCompactLayoutReceivedPopulated && isCompactLayoutReceived != isDisplayCompactLayoutUsed ) {
-    isDisplayCompactLayoutUsed = isCompactLayoutReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Compact layout updated"), true );
-    writeEepromBoolValue( eepromIsCompactLayoutShownIndex, isCompactLayoutReceived );
-  }
-
-  if( isClockAnimatedReceivedPopulated && isClockAnimatedReceived != isClockAnimated ) {
-    isClockAnimated = isClockAnimatedReceived;
-    writeToSerial( F("Clock animated updated"), true );
-    writeEepromBoolValue( eepromIsClockAnimatedIndex, isClockAnimatedReceived );
-  }
-
-
-  if( displayFontTypeNumberReceivedPopulated && displayFontTypeNumberReceived != displayFontTypeNumber ) {
-    displayFontTypeNumber = displayFontTypeNumberReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Display font updated"), true );
-    writeEepromUint8Value( eepromDisplayFontTypeNumberIndex, displayFontTypeNumberReceived );
-  }
-
-  if( isDisplayBoldFondUsedReceivedPopulated && isDisplayBoldFondUsedReceived != isDisplayBoldFontUsed ) {
-    isDisplayBoldFontUsed = isDisplayBoldFondUsedReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Show seconds updated"), true );
-    writeEepromBoolValue( eepromIsFontBoldUsedIndex, isDisplayBoldFondUsedReceived );
-  }
-
-  if( isDisplaySecondsShownReceivedPopulated && isDisplaySecondsShownReceived != isDisplaySecondsShown ) {
-    isDisplaySecondsShown = isDisplaySecondsShownReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Show seconds updated"), true );
-    writeEepromBoolValue( eepromIsDisplaySecondsShownIndex, isDisplaySecondsShownReceived );
-  }
-
-  if( isRotateDisplayReceivedPopulated && isRotateDisplayReceived != isRotateDisplay ) {
-    isRotateDisplay = isRotateDisplayReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Display rotation updated"), true );
-    writeEepromBoolValue( eepromIsRotateDisplayIndex, isRotateDisplayReceived );
-  }
-
-  if( animationTypeNumberReceivedPopulated && animationTypeNumberReceived != animationTypeNumber ) {
-    animationTypeNumber = animationTypeNumberReceived;
-    writeToSerial( F("Display animation updated"), true );
-    writeEepromUint8Value( eepromAnimationTypeNumberIndex, animationTypeNumberReceived );
-  }
-
-  if( isSlowSemicolonAnimationReceivedPopulated && isSlowSemicolonAnimationReceived != isSlowSemicolonAnimation ) {
-    isSlowSemicolonAnimation = isSlowSemicolonAnimationReceived;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Display semicolon speed updated"), true );
-    writeEepromBoolValue( eepromIsSlowSemicolonAnimationIndex, isSlowSemicolonAnimationReceived );
-    forceDisplaySync();
-  }
-
-  if( displayDayBrightnessReceivedPopulated && displayDayBrightnessReceived != displayDayBrightness ) {
-    displayDayBrightness = displayDayBrightnessReceived;
-    isDisplayIntensityUpdateRequiredAfterSettingChanged = true;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Display brightness updated"), true );
-    writeEepromUint8Value( eepromDisplayDayBrightnessIndex, displayDayBrightnessReceived );
-  }
-
-  if( displayNightBrightnessReceivedPopulated && displayNightBrightnessReceived != displayNightBrightness ) {
-    displayNightBrightness = displayNightBrightnessReceived;
-    isDisplayIntensityUpdateRequiredAfterSettingChanged = true;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Display night mode brightness updated"), true );
-    writeEepromUint8Value( eepromDisplayNightBrightnessIndex, displayNightBrightnessReceived );
-  }
-
-  if( sensorBrightnessDayReceivedPopulated && sensorBrightnessDayReceived != sensorBrightnessDayLevel ) {
-    sensorBrightnessDayLevel = sensorBrightnessDayReceived;
-    isDisplayIntensityUpdateRequiredAfterSettingChanged = true;
+  beginEepromTransaction(); //all changed settings are committed at once
+  uint8_t clockSettingEffects = 0;
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    const ClockSettingDescriptor& setting = CLOCK_SETTINGS[i];
+    uint16_t valueReceived = getClockSettingValue( clockSettingsReceived, setting );
+    if( valueReceived == getClockSettingValue( clockSettings, setting ) ) continue;
+    setClockSettingValue( clockSettings, setting, valueReceived );
+    writeEepromClockSetting( setting, valueReceived );
+    writeToSerial( String( F("Setting ") ) + setting.name + String( F(" updated to ") ) + String( valueReceived ), true );
+    clockSettingEffects |= setting.effects;
+  }
+  if( clockSettingEffects & CLOCK_SETTING_EFFECT_RERENDER ) {
     isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Sensor day brightness level updated"), true );
-    writeEepromUint16Value( eepromSensorBrightnessDayLevelIndex, sensorBrightnessDayReceived );
   }
-
-  if( sensorBrightnessNightReceivedPopulated && sensorBrightnessNightReceived != sensorBrightnessNightLevel ) {
-    sensorBrightnessNightLevel = sensorBrightnessNightReceived;
+  if( clockSettingEffects & CLOCK_SETTING_EFFECT_INTENSITY ) {
     isDisplayIntensityUpdateRequiredAfterSettingChanged = true;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Sensor night brightness level updated"), true );
-    writeEepromUint16Value( eepromSensorBrightnessNightLevelIndex, sensorBrightnessNightReceived );
   }
-
-  if( sensorBrightnessSteepnessReceivedPopulated && sensorBrightnessSteepnessReceived != brightnessSteepnessCoefficient ) {
-    brightnessSteepnessCoefficient = sensorBrightnessSteepnessReceived;
-    isDisplayIntensityUpdateRequiredAfterSettingChanged = true;
-    isDisplayRerenderRequiredAfterSettingChanged = true;
-    writeToSerial( F("Brightness steepness coefficient updated"), true );
-    writeEepromUint8Value( eepromBrightnessSteepnessCoefficientIndex, sensorBrightnessSteepnessReceived );
+  if( clockSettingEffects & CLOCK_SETTING_EFFECT_SYNC ) {
+    forceDisplaySync();
   }
 
   if( strcmp( deviceName, sanitizedDeviceNameReceived ) != 0 ) {
@@ -2278,22 +2903,23 @@ void handleWebServerPost() {
 
   if( isWiFiChanged ) {
     writeToSerial( F("WiFi settings updated"), true );
-    strncpy( wiFiClientSsid, htmlPageSsidNameReceived.c_str(), sizeof(wiFiClientSsid) );
-    writeEepromCharArray( eepromWiFiSsidIndex, wiFiClientSsid, sizeof(wiFiClientSsid) );
-    strncpy( wiFiClientPassword, htmlPageSsidPasswordReceived.c_str(), sizeof(wiFiClientPassword) );
-    writeEepromCharArray( eepromWiFiPasswordIndex, wiFiClientPassword, sizeof(wiFiClientPassword) );
-    shutdownAccessPoint();
-    connectToWiFiSync();
+    for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+      WiFiCredential& credential = wiFiCredentials[i];
+      if( strcmp( credential.ssid, htmlPageSsidNamesReceived[i].c_str() ) == 0 && strcmp( credential.password, htmlPageSsidPasswordsReceived[i].c_str() ) == 0 ) continue;
+      strncpy( credential.ssid, htmlPageSsidNamesReceived[i].c_str(), sizeof(credential.ssid) );
+      writeEepromCharArray( getEepromWiFiSsidIndex( i ), credential.ssid, sizeof(credential.ssid) );
+      strncpy( credential.password, htmlPageSsidPasswordsReceived[i].c_str(), sizeof(credential.password) );
+      writeEepromCharArray( getEepromWiFiPasswordIndex( i ), credential.password, sizeof(credential.password) );
+      if( strlen( credential.ssid ) != 0 ) {
+        promoteWiFiCredential( i ); //a newly entered network is most likely the one in reach
+      }
+    }
   }
-}
+  commitEepromTransaction();
 
-bool containsOnlyDigits( const String &str ) {
-  size_t length = str.length();
-  for( size_t i = 0; i < length; ++i ) {
-    if( isdigit( str.charAt(i) ) ) continue;
-    return false;
+  if( isWiFiChanged ) {
+    requestWiFiConnection();
   }
-  return true;
 }
 
 
@@ -2322,17 +2948,17 @@ void handleWebServerGetPreview() {
     secondStrPreview = "37";
   }
 
-  std::vector<std::vector<bool>> preview = getDisplayPreview( hourStrPreview, minuteStrPreview, secondStrPreview, fontNumber, isBold, isSecondsShown, isCompactLayout );
+  uint32_t preview[DISPLAY_HEIGHT];
+  getDisplayPreview( preview, hourStrPreview, minuteStrPreview, secondStrPreview, fontNumber, isBold, isSecondsShown, isCompactLayout );
   String response = "";
-  uint8_t lineNumber = 0;
+  response.reserve( 2 + DISPLAY_HEIGHT * ( DISPLAY_WIDTH + 6 ) + 1 );
   response += "[\n";
-  for( const auto& row : preview ) {
+  for( uint8_t displayY = 0; displayY < DISPLAY_HEIGHT; ++displayY ) {
     response += "  \"";
-    for( const bool value : row ) {
-      response += String( value ? "1": " " );
+    for( uint8_t displayX = 0; displayX < DISPLAY_WIDTH; ++displayX ) {
+      response += ( ( preview[displayY] << displayX ) & 0x80000000 ) ? '1' : ' ';
     }
-    lineNumber++;
-    response += "\"" + String( lineNumber < preview.size() ? "," : "" ) + String( F("\n") );
+    response += "\"" + String( displayY < DISPLAY_HEIGHT - 1 ? "," : "" ) + String( F("\n") );
   }
   response += "]";
   wifiWebServer.send( 200, getContentType( F("json") ), response );
@@ -2347,10 +2973,19 @@ void handleWebServerGetData() {
   if( !aniPreviewStr.length() ) aniPreviewStr = "0";
   uint8_t aniPreview = static_cast<uint8_t>( atoi( aniPreviewStr.c_str() ) );
 
-  if( aniPreview > 0 && aniPreview <= TCData::NUMBER_OF_ANIMATIONS_SUPPORTED ) {
+  if( aniPreview > 0 && aniPreview <= TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS ) {
     wifiWebServer.sendHeader( F("Cache-Control"), String( F("max-age=86400") ) );
     wifiWebServer.sendHeader( F("Content-Encoding"), F("gzip") );
     wifiWebServer.send_P( 200, getContentType( F("gif") ).c_str(), (const char*)TCData::getAnimation(aniPreview), TCData::getAnimationSize(aniPreview) );
+  } else if( aniPreview > TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS && aniPreview <= TCAnimations::getAnimationCount() ) { //custom animations may come with an /animationN.gif preview
+    File file = LittleFS.open( String( F("/animation") ) + String( aniPreview ) + String( F(".gif") ), "r" );
+    if( file ) {
+      wifiWebServer.streamFile( file, getContentType( F("gif") ) );
+      file.close();
+    } else {
+      wifiWebServer.sendHeader( F("Content-Encoding"), F("gzip") );
+      wifiWebServer.send_P( 200, getContentType( F("gif") ).c_str(), (const char*)TCData::getAnimation(0), TCData::getAnimationSize(0) );
+    }
   } else {
 
     String fileName = wifiWebServer.arg("f");
@@ -2396,6 +3031,7 @@ void handleWebServerSetDate() {
     newDateTime.tv_sec  = dt / 1000;
     newDateTime.tv_usec = 0;
     settimeofday( &newDateTime, NULL );
+    forceDisplaySync(); //render deadlines are based on the clock that has just been set
 
     wifiWebServer.send( 200, getContentType( F("json") ), "\"" + dtStr + "\"" );
   } else {
@@ -2410,15 +3046,11 @@ void handleWebServerSetDate() {
 void handleWebServerGetTestNight() {
   String content;
   addHtmlPageStart( content );
-  content += getHtmlPageFillup( "5", "5" ) + String( F("<h2>Перевіряю нічний режим...</h2>") );
+  content += getHtmlPageFillup( "5", "5" ) + String( F("<h2>Перевіряю нічний режим...</h2><a href=\"/testcancel\">Зупинити перевірку</a>") );
   addHtmlPageEnd( content );
   wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
   wifiWebServer.send( 200, getContentType( F("html") ), content );
-  setDisplayBrightness( displayNightBrightness );
-  renderDisplay();
-  delay( 6000 );
-  setDisplayBrightness( true );
-  renderDisplay();
+  startDisplayTest( DISPLAY_TEST_NIGHT );
 
   if( isApInitialized ) { //this resets AP timeout when user loads the page in AP mode
     apStartedMillis = millis();
@@ -2434,7 +3066,6 @@ void handleWebServerGetReset() {
   wifiWebServer.send( 200, getContentType( F("html") ), content );
 
   writeEepromUint8Value( eepromFlashDataVersionIndex, 255 );
-  EEPROM.commit();
 
   delay( 200 );
   ESP.restart();
@@ -2443,53 +3074,25 @@ void handleWebServerGetReset() {
 void handleWebServerGetTestLeds() {
   String content;
   addHtmlPageStart( content );
-  content += getHtmlPageFillup( "20", "20" ) + String( F("<h2>Перевіряю матрицю...</h2>") );
+  content += getHtmlPageFillup( "20", "20" ) + String( F("<h2>Перевіряю матрицю...</h2><a href=\"/testcancel\">Зупинити перевірку</a>") );
   addHtmlPageEnd( content );
   wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
   wifiWebServer.send( 200, getContentType( F("html") ), content );
-  for( uint8_t row = 0; row < 8; ++row ) {
-    for( uint8_t y = 0; y < 8; ++y ) {
-      for( uint8_t x = 0; x < 32; ++x ) {
-        display.setPoint( y, 32 - 1 - x, row == y );
-      }
-    }
-    display.update();
-    delay( 400 );
-  }
-  for( uint8_t column = 0; column < 31; ++column ) {
-    for( uint8_t y = 0; y < 8; ++y ) {
-      for( uint8_t x = 0; x < 32; ++x ) {
-        display.setPoint( y, 32 - 1 - x, column == x );
-      }
-    }
-    display.update();
-    delay( 200 );
-  }
-  for( uint8_t row = 2; row <= 8; row+=2 ) {
-    for( uint8_t y = 0; y < 8; ++y ) {
-      for( uint8_t x = 0; x < 32; ++x ) {
-        display.setPoint( y, 32 - 1 - x, ( x % row == y % row || x % row == row - y % row ) );
-      }
-    }
-    display.update();
-    delay( 1500 );
-  }
-  for( uint8_t row = 0; row < 4; ++row ) {
-    for( uint8_t y = 0; y < 8; ++y ) {
-      for( uint8_t x = 0; x < 32; ++x ) {
-        display.setPoint( y, 32 - 1 - x, ( ( x % 4 == row ) || ( y % 4 == row ) ) );
-      }
-    }
-    display.update();
-    delay( 1500 );
-  }
-  for( uint8_t y = 0; y < 8; ++y ) {
-    for( uint8_t x = 0; x < 32; ++x ) {
-      display.setPoint( y, 32 - 1 - x, true );
-    }
+  startDisplayTest( DISPLAY_TEST_LEDS );
+
+  if( isApInitialized ) { //this resets AP timeout when user loads the page in AP mode
+    apStartedMillis = millis();
   }
-  display.update();
-  delay( 1800 );
+}
+
+void handleWebServerGetTestCancel() {
+  stopDisplayTest();
+  String content;
+  addHtmlPageStart( content );
+  content += getHtmlPageFillup( "1", "1" ) + String( F("<h2>Перевірку зупинено</h2>") );
+  addHtmlPageEnd( content );
+  wifiWebServer.sendHeader( String( F("Content-Length") ).c_str(), String( content.length() ) );
+  wifiWebServer.send( 200, getContentType( F("html") ), content );
 
   if( isApInitialized ) { //this resets AP timeout when user loads the page in AP mode
     apStartedMillis = millis();
@@ -2515,6 +3118,68 @@ void handleWebServerGetPing() {
   }
 }
 
+String getJsonEscapedText( const char* text ) {
+  String result;
+  for( const char* c = text; *c != '\0'; c++ ) {
+    if( *c == '"' || *c == '\\' ) {
+      result += '\\';
+      result += *c;
+    } else if( (uint8_t)*c < 0x20 ) {
+      char escapedChar[7];
+      snprintf( escapedChar, sizeof(escapedChar), "\\u%04x", (uint8_t)*c );
+      result += escapedChar;
+    } else {
+      result += *c;
+    }
+  }
+  return result;
+}
+
+void handleWebServerGetScan() { //serves cached results; a new background scan is started when they are stale
+  bool isScanAllowed = wiFiState != WIFI_STATE_CONNECTING && wiFiState != WIFI_STATE_RADIO_OFF; //a scan would delay joining the router or wake the radio up
+  if( isScanAllowed && !isWiFiScanFresh() ) {
+    requestWiFiScan();
+  }
+
+  wifiWebServer.setContentLength( CONTENT_LENGTH_UNKNOWN );
+  wifiWebServer.send( 200, getContentType( F("json") ), "" );
+  String content = String( F(""
+  "{\n"
+    "\t\"scanning\": ") ) + String( isWiFiScanRunning ? "true" : "false" ) + String( F(",\n"
+    "\t\"age_ms\": ") ) + ( isWiFiScanCached ? String( calculateDiffMillis( wiFiScanCompletedMillis, millis() ) ) : String( F("null") ) ) + String( F(",\n"
+    "\t\"networks\": [\n") );
+  wifiWebServer.sendContent( content );
+  for( uint8_t i = 0; i < wiFiScanResultCount; i++ ) {
+    const WiFiScanResult& result = wiFiScanResults[i];
+    content = String( F("\t\t{ \"ssid\": \"") ) + getJsonEscapedText( result.ssid ) + String( F("\", \"rssi\": ") ) + String( result.rssi ) + String( F(", \"ch\": ") ) + String( result.channel ) + String( F(", \"enc\": ") ) + String( result.isEncrypted ? "true" : "false" ) + String( F(" }") ) + String( i < wiFiScanResultCount - 1 ? "," : "" ) + String( F("\n") );
+    wifiWebServer.sendContent( content );
+  }
+  wifiWebServer.sendContent( String( F("\t]\n}") ) );
+
+  if( isApInitialized ) { //this resets AP timeout when user loads the page in AP mode
+    apStartedMillis = millis();
+  }
+}
+
+String getClockSettingsJson() {
+  String content = "";
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    const ClockSettingDescriptor& setting = CLOCK_SETTINGS[i];
+    uint16_t value = getClockSettingValue( clockSettings, setting );
+    content += String( F("\t\t\"") ) + String( setting.name ) + String( F("\": ") ) + ( setting.type == CLOCK_SETTING_BOOL ? String( value ? "true" : "false" ) : String( value ) ) + String( i < CLOCK_SETTINGS_COUNT - 1 ? "," : "" ) + String( F("\n") );
+  }
+  return content;
+}
+
+String getSchedulerTasksJson() {
+  String content = "";
+  for( uint8_t taskId = 0; taskId < scheduler.getTaskCount(); ++taskId ) {
+    const TCScheduler::TaskStats& taskStats = scheduler.getTaskStats( taskId );
+    content += String( F("\t\t{ \"name\": \"") ) + String( taskStats.name ) + String( F("\", \"runs\": ") ) + String( taskStats.runs ) + String( F(", \"us\": ") ) + String( taskStats.runMicros ) + String( F(", \"max_us\": ") ) + String( taskStats.maxRunMicros ) + String( F(" }") ) + String( taskId < scheduler.getTaskCount() - 1 ? "," : "" ) + String( F("\n") );
+  }
+  return content;
+}
+
 void handleWebServerGetMonitor() {
   struct tm localTime;
   String hourStr, minuteStr, secondStr;
@@ -2554,7 +3219,10 @@ void handleWebServerGetMonitor() {
   String content = String( F(""
   "{\n"
     "\t\"net\": {\n"
-      "\t\t\"host\": \"") ) + getFullWiFiHostName() + String( F("\"\n"
+      "\t\t\"host\": \"") ) + getFullWiFiHostName() + String( F("\",\n"
+      "\t\t\"state\": \"") ) + getWiFiStateText( wiFiState ) + String( F("\",\n"
+      "\t\t\"conn_ms\": ") ) + String( wiFiLastConnectMillis ) + String( F(",\n"
+      "\t\t\"fast\": ") ) + String( isWiFiLastConnectFast ? "true" : "false" ) + String( F("\n"
     "\t},\n"
     "\t\"brt\": {\n"
       "\t\t\"cur\": ") ) + String( analogRead( BRIGHTNESS_INPUT_PIN ) ) + String( F(",\n"
@@ -2562,6 +3230,28 @@ void handleWebServerGetMonitor() {
       "\t\t\"req\": ") ) + String( displayCurrentBrightness ) + String( F(",\n"
       "\t\t\"dsp\": ") ) + String( static_cast<uint8_t>( round( displayPreviousBrightness ) ) ) + String( F("\n"
     "\t},\n"
+    "\t\"spi\": {\n"
+      "\t\t\"sent\": ") ) + String( displayBytesSentCount ) + String( F(",\n"
+      "\t\t\"saved\": ") ) + String( displayBytesSavedCount ) + String( F("\n"
+    "\t},\n"
+    "\t\"render\": {\n"
+      "\t\t\"rpm\": ") ) + String( displayRendersPerMinute ) + String( F(",\n"
+      "\t\t\"wps\": ") ) + String( displayRenderWakeupsPerSecond, 2 ) + String( F(",\n"
+      "\t\t\"wps_polling\": ") ) + String( DISPLAY_RENDER_WAKEUPS_PER_SECOND_POLLING ) + String( F("\n"
+    "\t},\n"
+    "\t\"cfg\": {\n"
+      "\t\t\"size\": ") ) + String( settingsJournal.getStats().fileSize ) + String( F(",\n"
+      "\t\t\"loaded\": ") ) + String( settingsJournal.getStats().recordsLoaded ) + String( F(",\n"
+      "\t\t\"load_us\": ") ) + String( settingsJournal.getStats().loadMicros ) + String( F(",\n"
+      "\t\t\"appended\": ") ) + String( settingsJournal.getStats().recordsAppended ) + String( F(",\n"
+      "\t\t\"written\": ") ) + String( settingsJournal.getStats().bytesWritten ) + String( F(",\n"
+      "\t\t\"compactions\": ") ) + String( settingsJournal.getStats().compactions ) + String( F(",\n"
+      "\t\t\"fallback\": ") ) + String( settingsJournal.getStats().isFallbackUsed ? "true" : "false" ) + String( F("\n"
+    "\t},\n"
+    "\t\"settings\": {\n") ) + getClockSettingsJson() + String( F(""
+    "\t},\n"
+    "\t\"tasks\": [\n") ) + getSchedulerTasksJson() + String( F(""
+    "\t],\n"
     #ifdef ESP8266
 
     #else //ESP32 or ESP32S2
@@ -2569,6 +3259,9 @@ void handleWebServerGetMonitor() {
       "\t\t\"present\": ") ) + String( isBatteryInstalled ? "true" : "false" ) + String( F(",\n"
       "\t\t\"used\": ") ) + String( isEnergySavingMode ? "true" : "false" ) + String( F("\n"
     "\t},\n"
+    "\t\"disp\": {\n"
+      "\t\t\"queue_overflows\": ") ) + String( displayCommandOverflowCount ) + String( F("\n"
+    "\t},\n"
     #endif
     "\t\"ram\": {\n"
       "\t\t\"heap\": ") ) + String( ESP.getFreeHeap() ) + String( F(""
@@ -2592,6 +3285,7 @@ void handleWebServerGetMonitor() {
       "\t\t\"cpu_freq\": ") ) + String( ESP.getCpuFreqMHz() ) + String( F(",\n"
       "\t\t\"flash_freq\": ") ) + String( ESP.getFlashChipSpeed() / 1000000 ) + String( F(",\n"
       "\t\t\"flash_mode\": \"") ) + flash_mode + String( F("\",\n"
+      "\t\t\"idle_loops\": ") ) + String( idleLoopsPercent ) + String( F(",\n"
       "\t\t\"millis\": ") ) + String( millis() ) + String( F("\n"
     "\t},\n"
     "\t\"clock\": {\n"
@@ -2601,7 +3295,7 @@ void handleWebServerGetMonitor() {
         #ifdef ESP8266
         timeClient.getLastUpdateMillis()
         #else
-        previousMillisNtpStatusCheck
+        ntpTimeSyncedMillis
         #endif
       ) : String( customDateTimeReceivedAt ) ) + String( F( "" ) ) ) : "null" ) + String( F("\n"
     "\t}\n"
@@ -2969,8 +3663,12 @@ void handleWebServerPostFont() {
           fontToUse[i][j] = body[byteIndex++];
       }
   }
+  lockDisplay(); //the font is read by the renderer
   TCFonts::setCustomFont( fontToUse );
+  displayGlyphCache.invalidate();
+  unlockDisplay();
   delete[] fontToUse;
+  requestDisplayRender();
 
   writeEepromFontData( false );
 
@@ -3007,8 +3705,10 @@ void configureWebServer() {
   wifiWebServer.on( "/testdim", HTTP_GET, handleWebServerGetTestNight );
   wifiWebServer.on( "/reset", HTTP_GET, handleWebServerGetReset );
   wifiWebServer.on( "/testled", HTTP_GET, handleWebServerGetTestLeds );
+  wifiWebServer.on( "/testcancel", HTTP_GET, handleWebServerGetTestCancel );
   wifiWebServer.on( "/reboot", HTTP_GET, handleWebServerGetReboot );
   wifiWebServer.on( "/ping", HTTP_GET, handleWebServerGetPing );
+  wifiWebServer.on( "/scan", HTTP_GET, handleWebServerGetScan );
   wifiWebServer.on( "/monitor", HTTP_GET, handleWebServerGetMonitor );
   wifiWebServer.on( "/favicon.ico", HTTP_GET, handleWebServerGetFavIcon );
   wifiWebServer.on( "/fontedit", HTTP_GET, handleWebServerGetFontEditor );
@@ -3023,17 +3723,26 @@ void configureWebServer() {
 
 #ifdef ESP8266
 WiFiEventHandler wiFiEventHandler;
+WiFiEventHandler wiFiGotIpEventHandler;
+WiFiEventHandler wiFiDisconnectedEventHandler;
 void onWiFiConnected( const WiFiEventStationModeConnected& event ) {
   writeToSerial( String( F("WiFi is connected to '") ) + String( event.ssid ) + String ( F("'") ), true );
 }
+void onWiFiGotIp( const WiFiEventStationModeGotIP& ) {
+  isWiFiEventPending = true;
+}
+void onWiFiDisconnected( const WiFiEventStationModeDisconnected& ) {
+  isWiFiEventPending = true;
+}
 #else //ESP32 or ESP32S2
 void WiFiEvent( WiFiEvent_t event ) {
   switch( event ) {
     case SYSTEM_EVENT_STA_GOT_IP:
       writeToSerial( String( F("WiFi is connected to '") ) + String( WiFi.SSID() ) + String ( F("' with IP ") ) + WiFi.localIP().toString(), true );
+      isWiFiEventPending = true;
       break;
     case SYSTEM_EVENT_STA_DISCONNECTED:
-      //
+      isWiFiEventPending = true;
       break;
     default:
       break;
@@ -3042,6 +3751,29 @@ void WiFiEvent( WiFiEvent_t event ) {
 #endif
 
 
+void internalLedProcessLoopTick() {
+  setInternalLedStatus( getInternalLedStatus() == HIGH ? LOW : HIGH );
+  scheduler.rescheduleTask( internalLedTaskId, getInternalLedStatus() == HIGH ? DELAY_INTERNAL_LED_ANIMATION_HIGH : DELAY_INTERNAL_LED_ANIMATION_LOW );
+}
+
+void initScheduler() {
+  internalLedTaskId = scheduler.addOneShotTask( "led", internalLedProcessLoopTick, 0 );
+  brightnessTaskId = scheduler.addPeriodicTask( "brightness", brightnessProcessLoopTick, DELAY_SENSOR_BRIGHTNESS_UPDATE_CHECK, DELAY_SENSOR_BRIGHTNESS_UPDATE_CHECK );
+  wiFiTaskId = scheduler.addOneShotTask( "wifi", wiFiProcessLoopTick, 0 );
+  ntpTaskId = scheduler.addPeriodicTask( "ntp", ntpProcessLoopTick, DELAY_NTP_CLIENT_UPDATE_CHECK, 0 );
+  #ifdef ESP8266
+
+  #else //ESP32 or ESP32S2
+  ntpStatusCheckTaskId = scheduler.addOneShotTask( "ntp_check", ntpStatusCheckProcessLoopTick, DELAY_NTP_STATUS_CHECK );
+  #endif
+  renderStatsTaskId = scheduler.addPeriodicTask( "stats", renderStatsProcessLoopTick, DELAY_RENDER_STATS_WINDOW, DELAY_RENDER_STATS_WINDOW );
+  displayTestTaskId = scheduler.addOneShotTask( "test", displayTestProcessLoopTick, 0 );
+  scheduler.cancelTask( displayTestTaskId ); //started by startDisplayTest()
+  wiFiScanTaskId = scheduler.addOneShotTask( "scan", wiFiScanProcessLoopTick, 0 );
+  scheduler.cancelTask( wiFiScanTaskId ); //started by requestWiFiScan()
+}
+
+
 void setup() {
   initVariables();
   initInternalLed();
@@ -3064,21 +3796,27 @@ void setup() {
 
   #endif
 
+  LittleFS.begin();
   initEeprom();
+  loadCustomAnimations(); //before loadEepromData(), so a saved custom animation type passes validation
   loadEepromData();
+  publishClockSettings();
   initDisplayPhase2();
-  LittleFS.begin();
 
   configureWebServer();
   #ifdef ESP8266
   wiFiEventHandler = WiFi.onStationModeConnected( &onWiFiConnected );
+  wiFiGotIpEventHandler = WiFi.onStationModeGotIP( &onWiFiGotIp );
+  wiFiDisconnectedEventHandler = WiFi.onStationModeDisconnected( &onWiFiDisconnected );
   #else //ESP32 or ESP32S2
   WiFi.onEvent( WiFiEvent );
   #endif
-  connectToWiFiAsync( true );
+  loadWiFiConnectionCache(); //the connection is started by the wifi task
   startWebServer();
   initNtpClient();
   initTimeZone();
+  initScheduler();
+  initDisplayRenderTask();
 }
 
 
@@ -3088,102 +3826,38 @@ void loop() {
     isDisplayIntensityUpdateRequiredAfterSettingChanged = false;
   }
   if( isDisplayRerenderRequiredAfterSettingChanged ) {
-    renderDisplay();
+    publishClockSettings();
+    requestDisplayRender();
     isDisplayRerenderRequiredAfterSettingChanged = false;
   }
 
-  unsigned long currentMillis = millis();
-
-  if( isFirstLoopRun || ( calculateDiffMillis( previousMillisInternalLed, currentMillis ) >= ( getInternalLedStatus() == HIGH ? DELAY_INTERNAL_LED_ANIMATION_HIGH : DELAY_INTERNAL_LED_ANIMATION_LOW ) ) ) {
-    previousMillisInternalLed = currentMillis;
-    setInternalLedStatus( getInternalLedStatus() == HIGH ? LOW : HIGH );
-  }
-
   if( isApInitialized ) {
     dnsServer.processNextRequest();
   }
   wifiWebServer.handleClient();
 
   powerModeProcessLoopTick( isFirstLoopRun );
-  brightnessProcessLoopTick();
 
-  bool isWiFiShutdown = isEnergySavingMode && isRouterSsidProvided() && timeCanBeCalculated();
-  if( isWiFiShutdown ) {
-    shutdownAccessPoint();
-    disconnectFromWiFi( true, false );
+  if( isWiFiEventPending || isWiFiShutdownRequired() != ( wiFiState == WIFI_STATE_RADIO_OFF ) ) {
+    scheduler.rescheduleTask( wiFiTaskId, 0 );
   }
 
-  currentMillis = millis();
-  if( isApInitialized && isRouterSsidProvided() && ( calculateDiffMillis( apStartedMillis, currentMillis ) >= TIMEOUT_AP ) ) {
-    if( !isWiFiShutdown ) {
-      shutdownAccessPoint();
-      connectToWiFiAsync( true );
-    }
-    previousMillisWiFiStatusCheck = currentMillis;
-  }
-
-  bool isWiFiStatusCheck = calculateDiffMillis( previousMillisWiFiStatusCheck, currentMillis ) >= DELAY_WIFI_CONNECTION_CHECK;
-  if( /*isFirstLoopRun || */isWiFiStatusCheck || WiFi.status() == WL_NO_SHIELD ) {
-    if( !isWiFiShutdown ) {
-      if( !WiFi.isConnected() ) {
-        if( !isApInitialized ) {
-          connectToWiFiAsync( isWiFiRadioShutDown ? true : false );
-        }
-      }
-    }
-    previousMillisWiFiStatusCheck = currentMillis;
-  }
-
-  ntpProcessLoopTick();
-
-  currentMillis = millis();
-  if( ( isFirstLoopRun && !isForceDisplaySync ) || isForceDisplaySync || ( calculateDiffMillis( previousMillisDisplayAnimation, currentMillis ) >= DELAY_DISPLAY_ANIMATION ) ) {
-    bool doRenderDisplay = true;
-    if( isForceDisplaySync ) {
-      unsigned long epochTimeSeconds = 0;
-      int epochTimeMillis = 0;
-      if( timeCanBeCalculated() ) {
-        struct timeval timeValue;
-        gettimeofday( &timeValue, NULL );
-        epochTimeSeconds = timeValue.tv_sec;
-        epochTimeMillis = timeValue.tv_usec / 1000;
-      } else {
-        epochTimeSeconds = currentMillis / 1000;
-        epochTimeMillis = currentMillis % 1000;
-      }
-      bool shouldSemicolonBeShown = isSlowSemicolonAnimation ? ( epochTimeSeconds % 2 == 0 ) : ( epochTimeMillis < 500 );
-      if( isSemicolonShown == shouldSemicolonBeShown ) {
-        doRenderDisplay = false;
-      }
-      isSemicolonShown = shouldSemicolonBeShown;
-      previousMillisSemicolonAnimation = currentMillis - ( isSlowSemicolonAnimation ? ( epochTimeMillis % 1000 ) : ( epochTimeMillis % 500 ) );
-      previousMillisDisplayAnimation = currentMillis - epochTimeMillis % DELAY_DISPLAY_ANIMATION;
-      isForceDisplaySync = false;
-    } else {
-      previousMillisDisplayAnimation += DELAY_DISPLAY_ANIMATION;
-      if( calculateDiffMillis( previousMillisSemicolonAnimation, currentMillis ) >= ( isSlowSemicolonAnimation ? 1000 : 500 ) ) {
-        isSemicolonShown = !isSemicolonShown;
-        previousMillisSemicolonAnimation += ( isSlowSemicolonAnimation ? 1000 : 500 );
-      }
-    }
-
-    if( doRenderDisplay || isForceDisplaySyncDisplayRenderOverride ) {
-      renderDisplay();
-      isForceDisplaySyncDisplayRenderOverride = false;
-    }
-  }
+  loopsCount++;
+  if( scheduler.run() == 0 ) idleLoopsCount++;
 
   isFirstLoopRun = false;
 
+  unsigned long millisUntilNextTask = scheduler.getMillisUntilNextTask(); //loop() never idles past the deadline of the next task
   #ifdef ESP8266
-  delay(2); //https://www.tablix.org/~avian/blog/archives/2022/08/saving_power_on_an_esp8266_web_server_using_delays/
+  delay( millisUntilNextTask < DELAY_LOOP_IDLE_MAX ? millisUntilNextTask : DELAY_LOOP_IDLE_MAX ); //https://www.tablix.org/~avian/blog/archives/2022/08/saving_power_on_an_esp8266_web_server_using_delays/
   #else //ESP32 or ESP32S2
-  if( isEnergySavingMode && isWiFiShutdown && WiFi.status() == WL_NO_SHIELD ) {
+  if( isEnergySavingMode && wiFiState == WIFI_STATE_RADIO_OFF && WiFi.status() == WL_NO_SHIELD && millisUntilNextTask > 0 ) {
     Serial.flush();
-    esp_sleep_enable_timer_wakeup(50 * 1000); //light sleep for 50 milliseconds
+    esp_sleep_enable_timer_wakeup( ( millisUntilNextTask < DELAY_LOOP_LIGHT_SLEEP_MAX ? millisUntilNextTask : DELAY_LOOP_LIGHT_SLEEP_MAX ) * 1000 );
     esp_light_sleep_start();
+    requestDisplayRender(); //the render timer does not run in light sleep
   } else {
-    delay(2); //https://www.tablix.org/~avian/blog/archives/2022/08/saving_power_on_an_esp8266_web_server_using_delays/
+    delay( millisUntilNextTask < DELAY_LOOP_IDLE_MAX ? millisUntilNextTask : DELAY_LOOP_IDLE_MAX ); //https://www.tablix.org/~avian/blog/archives/2022/08/saving_power_on_an_esp8266_web_server_using_delays/
   }
   #endif
 }
@@ -0,0 +1,96 @@
+//host benchmark of the per-frame display kernels in main.cpp: the framebuffer to MAX7219 register transpose, specialized per rotation, against the
+//generic transpose that tests the rotation inside its row loop, and the digit animation row blend
+//build with the optimization level of the firmware (-Os) or with -O2 and run from the repository root:
+//  g++ -std=gnu++11 -Os -DESP8266 -Itest/shim -Isrc test/display_render_benchmark.cpp test/shim/shim.cpp $(ls src/*.cpp | grep -v main.cpp) -o /tmp/display_render_benchmark && /tmp/display_render_benchmark
+//prints the best time per call of several interleaved runs; host timings only compare the kernels with each other, they do not predict the time on the ESP
+
+#include "../src/main.cpp"
+#include <chrono>
+#include <cstdio>
+
+const long CALLS_PER_RUN = 5000000;
+const uint8_t RUNS = 9;
+
+uint32_t benchmarkSink = 0; //keeps the compiler from dropping the kernel calls
+
+__attribute__((noinline)) void getDisplayRegistersGeneric( const uint32_t* frameBuffer, uint8_t (*displayRegisters)[DISPLAY_HEIGHT], bool isRotated ) { //the transpose before it was specialized: the rotation is tested for every row
+  for( uint8_t row = 0; row < DISPLAY_HEIGHT; ++row ) {
+    uint32_t rowBits = isRotated ? reverseBits32( frameBuffer[DISPLAY_HEIGHT - 1 - row] ) : frameBuffer[row];
+    for( uint8_t device = 0; device < MAX_MAX_DEVICES; ++device ) {
+      displayRegisters[device][row] = rowBits >> ( device * 8 );
+    }
+  }
+}
+
+template<typename Kernel> double getNanosPerCall( Kernel kernel ) {
+  std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+  for( long call = 0; call < CALLS_PER_RUN; call++ ) {
+    kernel( call );
+  }
+  return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - startedAt ).count() / CALLS_PER_RUN;
+}
+
+template<typename KernelA, typename KernelB> void printBestNanosPerCall( const char* nameA, KernelA kernelA, const char* nameB, KernelB kernelB ) { //runs of both kernels alternate, so a change of the machine load hits both
+  double bestNanosA = 0;
+  double bestNanosB = 0;
+  for( uint8_t run = 0; run < RUNS; run++ ) {
+    double nanosA = 0;
+    double nanosB = 0;
+    if( run % 2 == 0 ) {
+      nanosA = getNanosPerCall( kernelA );
+      nanosB = getNanosPerCall( kernelB );
+    } else {
+      nanosB = getNanosPerCall( kernelB );
+      nanosA = getNanosPerCall( kernelA );
+    }
+    if( run == 0 || nanosA < bestNanosA ) bestNanosA = nanosA;
+    if( run == 0 || nanosB < bestNanosB ) bestNanosB = nanosB;
+  }
+  printf( "%s: %.2f ns, %s: %.2f ns\n", nameA, bestNanosA, nameB, bestNanosB );
+}
+
+int main() {
+  uint32_t frameBuffer[DISPLAY_HEIGHT];
+  uint32_t frameBufferPrevious[DISPLAY_HEIGHT];
+  for( uint8_t row = 0; row < DISPLAY_HEIGHT; row++ ) {
+    frameBuffer[row] = (uint32_t)0x9E3779B9 * ( row + 1 );
+    frameBufferPrevious[row] = (uint32_t)0x7F4A7C15 * ( row + 1 );
+  }
+
+  for( uint8_t isRotated = 0; isRotated < 2; isRotated++ ) {
+    volatile bool isRotatedSetting = isRotated; //read at run time like the setting
+    GetDisplayRegistersKernel volatile kernel = isRotated ? &getDisplayRegisters<true> : &getDisplayRegisters<false>; //picked at run time like in updateDisplayRenderConfig()
+    printf( "getDisplayRegisters, %s\n  ", isRotated ? "rotated" : "not rotated" );
+    printBestNanosPerCall( "generic", [&]( long call ) {
+      uint8_t displayRegisters[MAX_MAX_DEVICES][DISPLAY_HEIGHT];
+      frameBuffer[call & ( DISPLAY_HEIGHT - 1 )] ^= call;
+      getDisplayRegistersGeneric( frameBuffer, displayRegisters, isRotatedSetting );
+      benchmarkSink += displayRegisters[call % MAX_MAX_DEVICES][call & ( DISPLAY_HEIGHT - 1 )];
+    }, "specialized", [&]( long call ) {
+      uint8_t displayRegisters[MAX_MAX_DEVICES][DISPLAY_HEIGHT];
+      frameBuffer[call & ( DISPLAY_HEIGHT - 1 )] ^= call;
+      kernel( frameBuffer, displayRegisters );
+      benchmarkSink += displayRegisters[call % MAX_MAX_DEVICES][call & ( DISPLAY_HEIGHT - 1 )];
+    } );
+  }
+
+  for( uint8_t animationNumber = 1; animationNumber <= TCAnimations::NUMBER_OF_BUILT_IN_ANIMATIONS; animationNumber++ ) {
+    TCAnimations::Animation animation;
+    TCAnimations::getAnimation( animationNumber, animation );
+    double bestNanos = 0;
+    for( uint8_t run = 0; run < RUNS; run++ ) {
+      double nanos = getNanosPerCall( [&]( long call ) {
+        uint32_t rows[DISPLAY_HEIGHT];
+        memcpy( rows, frameBuffer, sizeof(rows) );
+        frameBufferPrevious[call & ( DISPLAY_HEIGHT - 1 )] ^= call;
+        animateDisplayRows( rows, frameBufferPrevious, 0x00FFFF00, animation.rowSources[call % animation.steps] );
+        benchmarkSink += rows[call & ( DISPLAY_HEIGHT - 1 )];
+      } );
+      if( run == 0 || nanos < bestNanos ) bestNanos = nanos;
+    }
+    printf( "animateDisplayRows, animation %u: %.2f ns\n", animationNumber, bestNanos );
+  }
+
+  printf( "(%u)\n", benchmarkSink );
+  return 0;
+}
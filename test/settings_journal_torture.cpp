@@ -0,0 +1,128 @@
+//power-cut torture test of TCSettingsJournal against the in-memory LittleFS in test/shim
+//build and run from the repository root:
+//  g++ -std=gnu++11 -Wall -Itest/shim -Isrc test/settings_journal_torture.cpp test/shim/shim.cpp src/TCSettingsJournal.cpp -o /tmp/settings_journal_torture && /tmp/settings_journal_torture
+//exits with 0 when every trial passed
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <TCSettingsJournal.h>
+#include <cstdio>
+#include <vector>
+
+const uint16_t IMAGE_SIZE = 700;
+const uint32_t COMPACTION_SIZE = 2048;
+const int POWER_CUT_TRIALS = 4000;
+const int BIT_FLIP_TRIALS = 2000;
+
+typedef std::vector<uint8_t> Image;
+
+Image toImage( const uint8_t* image ) {
+  return Image( image, image + IMAGE_SIZE );
+}
+
+void writeRandomBytes( TCSettingsJournal& journal, int count ) {
+  for( int i = 0; i < count; i++ ) {
+    journal.write( rand() % IMAGE_SIZE, rand() );
+  }
+}
+
+bool reboot( uint8_t* image ) {
+  TCSettingsJournal journal( "/settings.a", "/settings.b", COMPACTION_SIZE );
+  return journal.begin( image, IMAGE_SIZE );
+}
+
+int runPowerCutTrials() { //a power cut during commit() or compact() leaves either the image before or the image after the interrupted call
+  int failures = 0;
+  for( int trial = 0; trial < POWER_CUT_TRIALS; trial++ ) {
+    shimFlashFiles.clear();
+    shimFlashWriteBudget = -1;
+
+    uint8_t image[IMAGE_SIZE];
+    TCSettingsJournal journal( "/settings.a", "/settings.b", COMPACTION_SIZE );
+    journal.begin( image, IMAGE_SIZE );
+    for( uint16_t i = 0; i < IMAGE_SIZE; i++ ) {
+      journal.write( i, rand() );
+    }
+    journal.commit();
+    int commitCount = rand() % 40;
+    for( int i = 0; i < commitCount; i++ ) {
+      writeRandomBytes( journal, 1 + rand() % 20 );
+      if( rand() % 10 == 0 ) journal.compact(); else journal.commit();
+    }
+
+    Image before = toImage( image );
+    writeRandomBytes( journal, 1 + rand() % 30 );
+    Image after = toImage( image );
+    shimFlashWriteBudget = rand() % 1000;
+    if( rand() % 4 == 0 ) journal.compact(); else journal.commit();
+    shimFlashWriteBudget = -1;
+
+    uint8_t loaded[IMAGE_SIZE];
+    if( !reboot( loaded ) || ( toImage( loaded ) != before && toImage( loaded ) != after ) ) {
+      printf( "power cut trial %d: loaded image is neither the one before nor the one after the interrupted call\n", trial );
+      failures++;
+      continue;
+    }
+
+    //the recovered journal keeps working
+    TCSettingsJournal recovered( "/settings.a", "/settings.b", COMPACTION_SIZE );
+    recovered.begin( loaded, IMAGE_SIZE );
+    recovered.write( 3, 0x42 );
+    recovered.commit();
+    Image expected = toImage( loaded );
+    uint8_t reloaded[IMAGE_SIZE];
+    if( !reboot( reloaded ) || toImage( reloaded ) != expected ) {
+      printf( "power cut trial %d: commit after recovery was lost\n", trial );
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int runBitFlipTrials() { //a flipped bit anywhere in the journal files falls back to a previously committed image
+  int failures = 0;
+  for( int trial = 0; trial < BIT_FLIP_TRIALS; trial++ ) {
+    shimFlashFiles.clear();
+    shimFlashWriteBudget = -1;
+
+    uint8_t image[IMAGE_SIZE];
+    TCSettingsJournal journal( "/settings.a", "/settings.b", COMPACTION_SIZE );
+    journal.begin( image, IMAGE_SIZE );
+    for( uint16_t i = 0; i < IMAGE_SIZE; i++ ) {
+      journal.write( i, rand() );
+    }
+    journal.commit();
+    journal.compact();
+    std::vector<Image> committedImages( 1, toImage( image ) );
+    for( int i = 0; i < 5; i++ ) {
+      writeRandomBytes( journal, 1 + rand() % 5 );
+      journal.commit();
+      committedImages.push_back( toImage( image ) );
+    }
+
+    std::vector<uint8_t>& file = shimFlashFiles[rand() % 2 == 0 ? "/settings.a" : "/settings.b"];
+    if( file.empty() ) continue;
+    file[rand() % file.size()] ^= 1 << ( rand() % 8 );
+
+    uint8_t loaded[IMAGE_SIZE];
+    bool isLoaded = reboot( loaded );
+    bool isCommittedImage = false;
+    for( size_t i = 0; i < committedImages.size(); i++ ) {
+      if( committedImages[i] == toImage( loaded ) ) isCommittedImage = true;
+    }
+    if( !isLoaded || !isCommittedImage ) {
+      printf( "bit flip trial %d: loaded image was never committed\n", trial );
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main() {
+  srand( 1 );
+  int powerCutFailures = runPowerCutTrials();
+  int bitFlipFailures = runBitFlipTrials();
+  printf( "power cut trials: %d, failed: %d\n", POWER_CUT_TRIALS, powerCutFailures );
+  printf( "bit flip trials: %d, failed: %d\n", BIT_FLIP_TRIALS, bitFlipFailures );
+  return powerCutFailures + bitFlipFailures == 0 ? 0 : 1;
+}
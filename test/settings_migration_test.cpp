@@ -0,0 +1,172 @@
+//host test of the settings import and data version migrations in main.cpp, run against the in-memory EEPROM and LittleFS in test/shim
+//build and run from the repository root:
+//  g++ -std=gnu++11 -DESP8266 -Itest/shim -Isrc test/settings_migration_test.cpp test/shim/shim.cpp $(ls src/*.cpp | grep -v main.cpp) -o /tmp/settings_migration_test && /tmp/settings_migration_test
+//exits with 0 when every check passed
+//
+//test/fixtures/settings_v3.bin is an EEPROM sector written by the v3 firmware (the baseline of this repository) after changing every setting from its default
+//data versions 1 and 2 do not appear in the history of this repository, so there is no layout to migrate them from; their images are reset to defaults
+
+#include "../src/main.cpp"
+#include <cstdio>
+#include <vector>
+
+int failedCheckCount = 0;
+
+#define CHECK( condition ) do { if( !( condition ) ) { printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition ); failedCheckCount++; } } while( 0 )
+
+std::vector<uint8_t> readFixture( const char* path ) {
+  std::vector<uint8_t> data;
+  FILE* file = fopen( path, "rb" );
+  if( file == NULL ) {
+    printf( "cannot open %s, run the test from the repository root\n", path );
+    exit( 2 );
+  }
+  int value;
+  while( ( value = fgetc( file ) ) != EOF ) {
+    data.push_back( value );
+  }
+  fclose( file );
+  return data;
+}
+
+void boot() { //resets the state setup() starts from and loads the settings the way setup() does
+  eepromFlashDataVersion = EEPROM_FLASH_DATA_VERSION;
+  memset( wiFiCredentials, 0, sizeof(wiFiCredentials) );
+  memset( deviceName, 0, sizeof(deviceName) );
+  clockSettings = ClockSettings();
+  initEeprom();
+  loadEepromData();
+}
+
+void checkDefaultSettings() {
+  for( uint8_t i = 0; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    CHECK( strlen( wiFiCredentials[i].ssid ) == 0 );
+    CHECK( strlen( wiFiCredentials[i].password ) == 0 );
+    CHECK( wiFiCredentials[i].successRank == i );
+  }
+  CHECK( strlen( deviceName ) == 0 );
+  for( uint8_t i = 0; i < CLOCK_SETTINGS_COUNT; i++ ) {
+    CHECK( getClockSettingValue( clockSettings, CLOCK_SETTINGS[i] ) == CLOCK_SETTINGS[i].defaultValue );
+  }
+}
+
+void checkV3FixtureSettings() { //the values written into the fixture
+  CHECK( strcmp( wiFiCredentials[0].ssid, "HomeNetwork" ) == 0 );
+  CHECK( strcmp( wiFiCredentials[0].password, "correct horse battery" ) == 0 );
+  CHECK( wiFiCredentials[0].successRank == 0 );
+  for( uint8_t i = 1; i < WIFI_CREDENTIALS_COUNT; i++ ) {
+    CHECK( strlen( wiFiCredentials[i].ssid ) == 0 );
+    CHECK( strlen( wiFiCredentials[i].password ) == 0 );
+    CHECK( wiFiCredentials[i].successRank == i );
+  }
+  CHECK( strcmp( deviceName, "Kitchen" ) == 0 );
+
+  CHECK( clockSettings.displayFontTypeNumber == 3 );
+  CHECK( clockSettings.isDisplayBoldFontUsed );
+  CHECK( clockSettings.isDisplaySecondsShown );
+  CHECK( clockSettings.displayDayBrightness == 12 );
+  CHECK( clockSettings.displayNightBrightness == 2 );
+  CHECK( clockSettings.sensorBrightnessDayLevel == 900 );
+  CHECK( clockSettings.sensorBrightnessNightLevel == 100 );
+  CHECK( clockSettings.brightnessSteepnessCoefficient == 30 );
+  CHECK( clockSettings.isSingleDigitHourShown );
+  CHECK( clockSettings.isRotateDisplay );
+  CHECK( clockSettings.isSlowSemicolonAnimation );
+  CHECK( clockSettings.isClockAnimated );
+  CHECK( clockSettings.animationTypeNumber == 2 );
+  CHECK( clockSettings.isDisplayCompactLayoutUsed );
+
+  uint8_t (*customFont)[TCFonts::FONT_HEIGHT] = TCFonts::getCustomFont();
+  bool isCustomFontKept = true;
+  for( uint16_t symbolIndex = 0; symbolIndex < TCFonts::FONT_SYMBOLS; symbolIndex++ ) {
+    for( uint8_t byteIndex = 0; byteIndex < TCFonts::FONT_HEIGHT; byteIndex++ ) {
+      isCustomFontKept = isCustomFontKept && customFont[symbolIndex][byteIndex] == (uint8_t)( symbolIndex * 7 + byteIndex );
+    }
+  }
+  CHECK( isCustomFontKept );
+}
+
+void testV3Migration( const std::vector<uint8_t>& v3Image ) {
+  shimFlashFiles.clear();
+  shimEepromSector = v3Image;
+  boot();
+  CHECK( eepromFlashDataVersion == EEPROM_FLASH_DATA_VERSION );
+  CHECK( settingsJournal.read( eepromFlashDataVersionIndex ) == EEPROM_FLASH_DATA_VERSION );
+  CHECK( shimEepromSector[eepromFlashDataVersionIndex] == EEPROM_IMPORTED_MARKER );
+  checkV3FixtureSettings();
+
+  boot(); //the migrated image is loaded from the journal
+  CHECK( settingsJournal.getStats().recordsLoaded > 0 );
+  checkV3FixtureSettings();
+
+  shimFlashFiles.clear(); //the journal is lost, e.g. by a filesystem upload; the imported sector is not read again
+  boot();
+  checkDefaultSettings();
+}
+
+uint16_t getEepromV3Index( uint16_t eepromIndex ) { //index of a setting after the WiFi network in the v3 layout, which stored a single network
+  return eepromIndex - eepromDeviceNameIndex + eepromWiFiCredentialsIndex + sizeof(WiFiCredential::ssid) + sizeof(WiFiCredential::password);
+}
+
+void testOutOfRangeValues( const std::vector<uint8_t>& v3Image ) { //values out of range are clamped or reset per setting, as the v3 firmware did
+  shimFlashFiles.clear();
+  shimEepromSector = v3Image;
+  uint16_t sensorLevel = ADC_NUMBER_OF_VALUES + 100;
+  shimEepromSector[getEepromV3Index( eepromDisplayFontTypeNumberIndex )] = TCFonts::NUMBER_OF_FONTS_SUPPORTED + 1;
+  shimEepromSector[getEepromV3Index( eepromIsFontBoldUsedIndex )] = 7;
+  shimEepromSector[getEepromV3Index( eepromDisplayDayBrightnessIndex )] = 20;
+  shimEepromSector[getEepromV3Index( eepromDisplayNightBrightnessIndex )] = 18;
+  shimEepromSector[getEepromV3Index( eepromSensorBrightnessDayLevelIndex )] = sensorLevel & 0xFF;
+  shimEepromSector[getEepromV3Index( eepromSensorBrightnessDayLevelIndex ) + 1] = sensorLevel >> 8;
+  shimEepromSector[getEepromV3Index( eepromSensorBrightnessNightLevelIndex )] = sensorLevel & 0xFF;
+  shimEepromSector[getEepromV3Index( eepromSensorBrightnessNightLevelIndex ) + 1] = sensorLevel >> 8;
+  shimEepromSector[getEepromV3Index( eepromAnimationTypeNumberIndex )] = 200;
+  boot();
+  CHECK( eepromFlashDataVersion == EEPROM_FLASH_DATA_VERSION );
+  CHECK( clockSettings.displayFontTypeNumber == 1 );
+  CHECK( clockSettings.isDisplayBoldFontUsed );
+  CHECK( clockSettings.displayDayBrightness == 15 );
+  CHECK( clockSettings.displayNightBrightness == 15 );
+  CHECK( clockSettings.sensorBrightnessDayLevel == ADC_NUMBER_OF_VALUES - 1 );
+  CHECK( clockSettings.sensorBrightnessNightLevel == 0 );
+  CHECK( clockSettings.animationTypeNumber == 1 );
+  CHECK( clockSettings.brightnessSteepnessCoefficient == 30 ); //settings in range are kept
+  CHECK( strcmp( deviceName, "Kitchen" ) == 0 );
+
+  boot(); //the loaded values are not written back, the same ones are loaded again
+  CHECK( clockSettings.displayDayBrightness == 15 );
+  CHECK( clockSettings.sensorBrightnessDayLevel == ADC_NUMBER_OF_VALUES - 1 );
+  CHECK( clockSettings.sensorBrightnessNightLevel == 0 );
+}
+
+void testUnsupportedVersion( const std::vector<uint8_t>& v3Image, uint8_t version ) {
+  shimFlashFiles.clear();
+  shimEepromSector = v3Image;
+  shimEepromSector[eepromFlashDataVersionIndex] = version;
+  boot();
+  CHECK( eepromFlashDataVersion == EEPROM_FLASH_DATA_VERSION );
+  checkDefaultSettings();
+}
+
+void testErasedSector() { //a new board
+  shimFlashFiles.clear();
+  shimEepromSector.assign( EEPROM_ALLOCATED_SIZE, 0xFF );
+  boot();
+  CHECK( eepromFlashDataVersion == EEPROM_FLASH_DATA_VERSION );
+  checkDefaultSettings();
+}
+
+int main() {
+  std::vector<uint8_t> v3Image = readFixture( "test/fixtures/settings_v3.bin" );
+  CHECK( v3Image[eepromFlashDataVersionIndex] == 3 );
+  v3Image.resize( EEPROM_ALLOCATED_SIZE, 0xFF ); //the v4 image is longer, the EEPROM sector after the v3 image is erased flash
+
+  testV3Migration( v3Image );
+  testOutOfRangeValues( v3Image );
+  testUnsupportedVersion( v3Image, 1 );
+  testUnsupportedVersion( v3Image, 2 );
+  testErasedSector();
+
+  printf( "failed checks: %d\n", failedCheckCount );
+  return failedCheckCount == 0 ? 0 : 1;
+}
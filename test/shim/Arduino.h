@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <ctime>
+#include <string>
+#include <sys/time.h>
+#include <algorithm>
+typedef unsigned int uint;
+typedef uint8_t byte;
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define PGM_P const char*
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define A0 17
+#define LED_BUILTIN 2
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+enum { REASON_DEFAULT_RST = 0, REASON_EXT_SYS_RST = 6 }; struct rst_info { uint32_t reason; };
+inline uint16_t word(uint8_t h, uint8_t l) { return (h << 8) | l; }
+void randomSeed(unsigned long);
+long random(long, long);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void yield();
+int digitalRead(uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+void pinMode(uint8_t, uint8_t);
+int analogRead(uint8_t);
+class String {
+ public:
+  std::string s;
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const char* c, size_t n) : s(c, n) {}
+  String(const __FlashStringHelper* c) : s((const char*)c) {}
+  String(const String& o) = default;
+  String& operator=(const String& o) = default;
+  explicit String(char c) : s(1, c) {}
+  explicit String(int v) : s(std::to_string(v)) {}
+  explicit String(unsigned int v) : s(std::to_string(v)) {}
+  explicit String(long v) : s(std::to_string(v)) {}
+  explicit String(unsigned long v) : s(std::to_string(v)) {}
+  explicit String(long long v) : s(std::to_string(v)) {}
+  explicit String(unsigned long long v) : s(std::to_string(v)) {}
+  explicit String(unsigned char v) : s(std::to_string(v)) {}
+  explicit String(bool v) : s(std::to_string((int)v)) {}
+  explicit String(double v, unsigned char d = 2) : s(std::to_string(v)) {}
+  explicit String(float v, unsigned char d = 2) : s(std::to_string(v)) {}
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  bool reserve(unsigned int n) { s.reserve(n); return true; }
+  char charAt(unsigned int i) const { return s[i]; }
+  char operator[](unsigned int i) const { return s[i]; }
+  char& operator[](unsigned int i) { return s[i]; }
+  String substring(unsigned int a) const { return String(s.substr(a).c_str()); }
+  String substring(unsigned int a, unsigned int b) const { return String(s.substr(a, b - a).c_str()); }
+  int indexOf(const char* c) const { auto p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(char c) const { auto p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String& o) const { return indexOf(o.c_str()); }
+  int lastIndexOf(const char* c) const { auto p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c) const { auto p = s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+  bool endsWith(const String& o) const { return s.size() >= o.s.size() && s.compare(s.size() - o.s.size(), o.s.size(), o.s) == 0; }
+  bool startsWith(const String& o) const { return s.compare(0, o.s.size(), o.s) == 0; }
+  void remove(unsigned int i, unsigned int n) { s.erase(i, n); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  void trim() {}
+  void toLowerCase() {}
+  bool equals(const String& o) const { return s == o.s; }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(const __FlashStringHelper* o) { s += (const char*)o; return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned long o) { s += std::to_string(o); return *this; }
+  bool concat(const char* c, unsigned int n) { s.append(c, n); return true; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  bool operator<(const String& o) const { return s < o.s; }
+};
+class StringSumHelper : public String { public: using String::String; StringSumHelper(const String& o) : String(o) {} };
+inline StringSumHelper operator+(const StringSumHelper& a, const String& b) { StringSumHelper r(a); r.s += b.s; return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, const char* b) { StringSumHelper r(a); r.s += b; return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, char b) { StringSumHelper r(a); r.s += b; return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, const __FlashStringHelper* b) { StringSumHelper r(a); r.s += (const char*)b; return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, int b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, unsigned int b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, long b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, unsigned long b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const StringSumHelper& a, unsigned char b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const String& a, const String& b) { StringSumHelper r(a); r.s += b.s; return r; }
+inline StringSumHelper operator+(const String& a, const char* b) { StringSumHelper r(a); r.s += b; return r; }
+inline StringSumHelper operator+(const String& a, char b) { StringSumHelper r(a); r.s += b; return r; }
+inline StringSumHelper operator+(const String& a, const __FlashStringHelper* b) { StringSumHelper r(a); r.s += (const char*)b; return r; }
+inline StringSumHelper operator+(const String& a, int b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const String& a, unsigned int b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const String& a, unsigned long b) { StringSumHelper r(a); r.s += std::to_string(b); return r; }
+inline StringSumHelper operator+(const char* a, const String& b) { StringSumHelper r(a); r.s += b.s; return r; }
+inline StringSumHelper operator+(const __FlashStringHelper* a, const String& b) { StringSumHelper r(a); r.s += b.s; return r; }
+inline StringSumHelper operator+(char a, const String& b) { StringSumHelper r; r.s = a; r.s += b.s; return r; }
+extern const String emptyString;
+class Print { public: virtual size_t write(uint8_t) { return 1; } virtual size_t write(const uint8_t* b, size_t n) { return n; }
+  size_t print(const String&) { return 0; } size_t println(const String&) { return 0; } size_t print(const char*) { return 0; } size_t println(const char*) { return 0; } size_t printf(const char*, ...) { return 0; } };
+class Stream : public Print { public: virtual int available() { return 0; } virtual int read() { return -1; } size_t readBytes(uint8_t* b, size_t n) { return n; } size_t readBytes(char* b, size_t n) { return n; } };
+class HardwareSerial : public Stream { public: void begin(unsigned long) {} void flush() {} };
+extern HardwareSerial Serial;
+class IPAddress { public: IPAddress() {} IPAddress(uint8_t,uint8_t,uint8_t,uint8_t) {} IPAddress(uint32_t) {} String toString() const { return String(); } operator uint32_t() const { return 0; } bool fromString(const char*) { return true; } bool isSet() const { return true; } uint8_t operator[](int) const { return 0; } };
+enum FlashMode_t { FM_QIO, FM_QOUT, FM_DIO, FM_DOUT, FM_FAST_READ, FM_SLOW_READ, FM_UNKNOWN };
+class EspClass { public:
+  rst_info* getResetInfoPtr() { static rst_info i = { REASON_EXT_SYS_RST }; return &i; } uint32_t getChipId() { return 0; } uint64_t getEfuseMac() { return 0; } uint8_t getCpuFreqMHz() { return 160; }
+  FlashMode_t getFlashChipMode() { return FM_QIO; } uint32_t getFlashChipSpeed() { return 0; } uint32_t getFreeHeap() { return 0; }
+  uint8_t getHeapFragmentation() { return 0; } void restart() {} uint32_t getCycleCount() { return 0; }
+  bool rtcUserMemoryRead(uint32_t, uint32_t*, size_t) { return true; } bool rtcUserMemoryWrite(uint32_t, uint32_t*, size_t) { return true; }
+  uint32_t getMaxFreeBlockSize() { return 0; } };
+extern EspClass ESP;
+#define UDP_TX_PACKET_MAX_SIZE 8192
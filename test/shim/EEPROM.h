@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+//in-memory EEPROM sector for host tests; shimEepromSector persists across begin()/end() like the flash sector does
+extern std::vector<uint8_t> shimEepromSector;
+class EEPROMClass { public:
+  std::vector<uint8_t> cache;
+  void begin(size_t size) { if( shimEepromSector.size() < size ) shimEepromSector.resize( size, 0xFF ); cache.assign( shimEepromSector.begin(), shimEepromSector.begin() + size ); }
+  uint8_t read(int i) { return cache[i]; } void write(int i, uint8_t v) { cache[i] = v; }
+  bool commit() { std::copy( cache.begin(), cache.end(), shimEepromSector.begin() ); return true; } bool end() { commit(); cache.clear(); return true; }
+  uint8_t* getDataPtr() { return cache.data(); } const uint8_t* getConstDataPtr() const { return cache.data(); } size_t length() { return cache.size(); }
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,3 @@
+#pragma once
+#include <ESP8266WebServer.h>
+class ESP8266HTTPUpdateServer { public: void setup(ESP8266WebServer*) {} };
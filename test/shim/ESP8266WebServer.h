@@ -0,0 +1,23 @@
+#pragma once
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <functional>
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+class ESP8266WebServer { public:
+  ESP8266WebServer(int) {}
+  typedef std::function<void(void)> THandlerFunction;
+  void on(const char*, HTTPMethod, THandlerFunction) {}
+  void onNotFound(THandlerFunction) {}
+  String arg(const char*) { return String(); } String arg(const String&) { return String(); }
+  bool hasArg(const char*) { return false; } bool hasArg(const String&) { return false; }
+  void send(int, const char*, const String&) {} void send(int, const String&, const String&) {} void send(int, const char*, const char*) {} void send(int, const String&, const __FlashStringHelper*) {}
+  void send_P(int, const char*, const char*, size_t) {} void send_P(int, const char*, const char*) {}
+  void sendHeader(const String&, const String&, bool = false) {}
+  void sendContent(const String&) {} void sendContent(const char*, size_t) {}
+  void sendContent_P(const char*) {} void sendContent_P(const char*, size_t) {}
+  void setContentLength(size_t) {}
+  WiFiClient& client() { static WiFiClient c; return c; }
+  template<typename T> size_t streamFile(T&, const String&) { return 0; }
+  void handleClient() {} void begin() {} void stop() {}
+};
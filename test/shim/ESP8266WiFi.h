@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+typedef enum { WL_NO_SHIELD = 255, WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_WRONG_PASSWORD = 6, WL_DISCONNECTED = 7 } wl_status_t;
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } WiFiMode_t;
+struct WiFiEventStationModeConnected { String ssid; uint8_t bssid[6]; uint8_t channel; };
+struct WiFiEventStationModeDisconnected { String ssid; uint8_t bssid[6]; uint8_t reason; };
+struct WiFiEventStationModeGotIP { IPAddress ip; IPAddress mask; IPAddress gw; };
+struct WiFiEventHandlerOpaque {};
+typedef std::shared_ptr<WiFiEventHandlerOpaque> WiFiEventHandler;
+class WiFiClient : public Stream { public: using Print::write; size_t write(const uint8_t* b, size_t n) override { return n; } void stop() {} bool connected() { return true; } };
+class WiFiServer {};
+class ESP8266WiFiClass { public:
+  wl_status_t status() { return WL_CONNECTED; }
+  bool isConnected() { return true; }
+  wl_status_t begin(const char*, const char* = nullptr, int32_t = 0, const uint8_t* = nullptr, bool = true) { return WL_CONNECTED; }
+  bool disconnect(bool = false, bool = false) { return true; }
+  bool disconnect(bool) { return true; }
+  bool hostname(const char*) { return true; }
+  String SSID() const { return String(); }
+  String SSID(uint8_t) const { return String(); }
+  int32_t RSSI() { return 0; } int32_t RSSI(uint8_t) { return 0; }
+  uint8_t* BSSID() { return nullptr; } uint8_t* BSSID(uint8_t) { return nullptr; }
+  int32_t channel() { return 0; } int32_t channel(uint8_t) { return 0; }
+  uint8_t encryptionType(uint8_t) { return 0; }
+  IPAddress localIP() { return IPAddress(); } IPAddress gatewayIP() { return IPAddress(); } IPAddress subnetMask() { return IPAddress(); } IPAddress dnsIP(uint8_t = 0) { return IPAddress(); }
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+  bool softAPConfig(IPAddress, IPAddress, IPAddress) { return true; }
+  bool softAP(const char*, const char* = nullptr, int = 1, int = 0, int = 4) { return true; }
+  bool softAPdisconnect(bool = false) { return true; }
+  IPAddress softAPIP() { return IPAddress(); }
+  WiFiEventHandler onStationModeConnected(std::function<void(const WiFiEventStationModeConnected&)>) { return WiFiEventHandler(); }
+  WiFiEventHandler onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)>) { return WiFiEventHandler(); }
+  WiFiEventHandler onStationModeGotIP(std::function<void(const WiFiEventStationModeGotIP&)>) { return WiFiEventHandler(); }
+  int8_t scanNetworks(bool = false, bool = false) { return 0; }
+  int8_t scanComplete() { return 0; }
+  void scanDelete() {}
+  bool mode(WiFiMode_t) { return true; }
+  WiFiMode_t getMode() { return WIFI_STA; }
+  bool setAutoReconnect(bool) { return true; }
+  bool persistent(bool) { return true; }
+  bool forceSleepBegin() { return true; } bool forceSleepWake() { return true; }
+};
+extern ESP8266WiFiClass WiFi;
+#define ENC_TYPE_NONE 7
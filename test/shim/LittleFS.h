@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <vector>
+//in-memory LittleFS for host tests; shimFlashWriteBudget >= 0 simulates a power cut after that many more bytes are written
+extern std::map<std::string, std::vector<uint8_t>> shimFlashFiles;
+extern long shimFlashWriteBudget;
+class File : public Stream { public:
+  std::string path; size_t pos = 0; bool isOpen = false;
+  operator bool() const { return isOpen; }
+  bool isDirectory() { return false; } File openNextFile() { return File(); } const char* name() const { return path.c_str(); } void close() { isOpen = false; } void flush() {}
+  size_t size() const { return isOpen ? shimFlashFiles[path].size() : 0; } size_t position() const { return pos; } bool seek(uint32_t p) { if( p > size() ) return false; pos = p; return true; }
+  int available() override { return isOpen ? (int)( size() - pos ) : 0; }
+  using Stream::read; int read(uint8_t* b, size_t n) { std::vector<uint8_t>& data = shimFlashFiles[path]; size_t k = std::min( n, data.size() - pos ); memcpy( b, data.data() + pos, k ); pos += k; return k; }
+  using Print::write; size_t write(const uint8_t* b, size_t n) override { std::vector<uint8_t>& data = shimFlashFiles[path]; for( size_t i = 0; i < n; i++ ) { if( shimFlashWriteBudget == 0 ) return i; if( shimFlashWriteBudget > 0 ) shimFlashWriteBudget--; data.push_back( b[i] ); pos = data.size(); } return n; }
+};
+class FSClass { public:
+  bool begin() { return true; } bool begin(bool) { return true; } size_t totalBytes() { return 0; } size_t usedBytes() { return 0; } bool mkdir(const char*) { return true; }
+  File open(const String& p, const char* m) { return open( p.c_str(), m ); }
+  File open(const char* p, const char* m) { File f; f.path = p; f.isOpen = true; if( m[0] == 'r' ) { if( !shimFlashFiles.count( p ) ) f.isOpen = false; } else if( m[0] == 'w' ) { shimFlashFiles[p].clear(); } else { f.pos = shimFlashFiles[p].size(); } return f; }
+  bool exists(const char* p) { return shimFlashFiles.count( p ) != 0; } bool exists(const String& p) { return exists( p.c_str() ); }
+  bool remove(const char* p) { return shimFlashFiles.erase( p ) != 0; } bool remove(const String& p) { return remove( p.c_str() ); }
+  bool rename(const char* a, const char* b) { if( !exists( a ) ) return false; shimFlashFiles[b] = shimFlashFiles[a]; shimFlashFiles.erase( a ); return true; } bool rename(const String& a, const String& b) { return rename( a.c_str(), b.c_str() ); }
+};
+extern FSClass LittleFS;
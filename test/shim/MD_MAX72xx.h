@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+class MD_MAX72XX { public:
+  enum moduleType_t { GENERIC_HW, FC16_HW, PAROLA_HW, ICSTATION_HW, DR0CR0RR0_HW };
+  enum controlRequest_t { SHUTDOWN, SCANLIMIT, INTENSITY, TEST, DECODE, UPDATE, WRAPAROUND };
+  enum controlValue_t { OFF = 0, ON = 1 };
+  MD_MAX72XX(moduleType_t, uint8_t, uint8_t) {}
+  MD_MAX72XX(moduleType_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+  uint8_t m[4][8] = {}; uint8_t changed[4] = {}; unsigned long spiBytes = 0; unsigned long updates = 0;
+  void begin() {}
+  bool control(controlRequest_t, int) { return true; }
+  bool control(uint8_t, controlRequest_t, int) { return true; }
+  bool control(uint8_t, uint8_t, controlRequest_t, int) { return true; }
+  void clear() {} void clear(uint8_t) {}
+  bool setPoint(uint8_t r, uint16_t c, bool st) { if (r > 7 || c > 31) return false; if (st) m[c/8][r] |= (1 << (c%8)); else m[c/8][r] &= ~(1 << (c%8)); changed[c/8] |= (1 << r); return true; }
+  bool getPoint(uint8_t r, uint16_t c) { return (m[c/8][r] >> (c%8)) & 1; }
+  bool setColumn(uint16_t c, uint8_t v) { if (c > 31) return false; for (int r = 0; r < 8; r++) { if ((v >> r) & 1) m[c/8][r] |= (1 << (c%8)); else m[c/8][r] &= ~(1 << (c%8)); } changed[c/8] = 0xFF; return true; }
+  bool setColumn(uint8_t, uint8_t, uint8_t) { return true; }
+  uint8_t getColumn(uint16_t) { return 0; }
+  bool setRow(uint8_t, uint8_t) { return true; }
+  bool setRow(uint8_t d, uint8_t r, uint8_t v) { if (d > 3 || r > 7) return false; m[d][r] = v; changed[d] |= (1 << r); return true; }
+  bool setRow(uint8_t, uint8_t, uint8_t, uint8_t) { return true; }
+  uint8_t getRow(uint8_t, uint8_t) { return 0; }
+  bool setBuffer(uint16_t col, uint8_t size, uint8_t* pd) { for (uint8_t i = 0; i < size; i++) setColumn(col--, *pd++); return true; }
+  void getBuffer(uint16_t, uint8_t, uint8_t*) {}
+  void update() { updates++; for (int r = 0; r < 8; r++) { bool any = false; for (int d = 0; d < 4; d++) any = any || ((changed[d] >> r) & 1); if (any) spiBytes += 8; } for (int d = 0; d < 4; d++) changed[d] = 0; } void update(controlValue_t) {} bool update(uint8_t) { return true; }
+  uint16_t getColumnCount() { return 32; }
+  uint8_t getDeviceCount() { return 4; }
+};
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class UDP : public Stream { public: virtual uint8_t begin(uint16_t) { return 1; } virtual void stop() {} virtual int beginPacket(IPAddress, uint16_t) { return 1; } virtual int beginPacket(const char*, uint16_t) { return 1; } virtual int endPacket() { return 1; } virtual int parsePacket() { return 0; } virtual int read(unsigned char*, size_t) { return 0; } using Stream::read; using Print::write; virtual IPAddress remoteIP() { return IPAddress(); } virtual void flush() {} };
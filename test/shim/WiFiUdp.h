@@ -0,0 +1,3 @@
+#pragma once
+#include <Udp.h>
+class WiFiUDP : public UDP {};
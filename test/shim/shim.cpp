@@ -0,0 +1,10 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+const String emptyString;
+HardwareSerial Serial; EspClass ESP; ESP8266WiFiClass WiFi; EEPROMClass EEPROM; FSClass LittleFS;
+std::map<std::string, std::vector<uint8_t>> shimFlashFiles; long shimFlashWriteBudget = -1; std::vector<uint8_t> shimEepromSector;
+unsigned long shimMillis = 0; unsigned long millis() { return shimMillis; } unsigned long micros() { return shimMillis * 1000; } void delay(unsigned long ms) { shimMillis += ms; } void yield() {}
+int digitalRead(uint8_t) { return 0; } void digitalWrite(uint8_t, uint8_t) {} void pinMode(uint8_t, uint8_t) {} int analogRead(uint8_t) { return 0; }
+void randomSeed(unsigned long) {} long random(long a, long b) { return b > a ? a + rand() % ( b - a ) : a; }